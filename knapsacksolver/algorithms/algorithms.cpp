@@ -14,6 +14,9 @@ ExpknapOptionalParameters read_expknap_args(std::vector<char*> argv)
         ("greedynlogn,n", po::value<StateIdx>(&p.greedynlogn), "")
         ("surrelax,s", po::value<StateIdx>(&p.surrelax), "")
         ("combo-core,c", "")
+        ("threads,t", po::value<Counter>(&p.thread_number), "")
+        ("best-first,b", "")
+        ("best-first-nodes", po::value<StateIdx>(&p.best_first_node_number_max), "")
         ;
     po::variables_map vm;
     po::store(po::parse_command_line((Counter)argv.size(), argv.data(), desc), vm);
@@ -25,6 +28,7 @@ ExpknapOptionalParameters read_expknap_args(std::vector<char*> argv)
     }
     if (vm.count("greedy")) p.greedy = true;
     if (vm.count("combo-core")) p.combo_core = true;
+    if (vm.count("best-first")) p.best_first = true;
     return p;
 }
 
@@ -38,6 +42,7 @@ BalknapOptionalParameters read_balknap_args(std::vector<char*> argv)
         ("greedynlogn,n", po::value<StateIdx>(&p.greedynlogn), "")
         ("surrelax,s", po::value<StateIdx>(&p.surrelax), "")
         ("partial-solution-size,k", po::value<ItemIdx>(&p.partial_solution_size), "")
+        ("threads,t", po::value<Counter>(&p.thread_number), "")
         ;
     po::variables_map vm;
     po::store(po::parse_command_line((Counter)argv.size(), argv.data(), desc), vm);
@@ -51,6 +56,77 @@ BalknapOptionalParameters read_balknap_args(std::vector<char*> argv)
     return p;
 }
 
+Counter read_thread_number(std::vector<char*> argv, Counter thread_number = 2)
+{
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("threads,t", po::value<Counter>(&thread_number), "")
+        ;
+    po::variables_map vm;
+    po::store(po::parse_command_line((Counter)argv.size(), argv.data(), desc), vm);
+    try {
+        po::notify(vm);
+    } catch (const po::required_option& e) {
+        std::cout << desc << std::endl;;
+        throw "";
+    }
+    return thread_number;
+}
+
+StateIdx read_memory_limit(std::vector<char*> argv)
+{
+    StateIdx memory_limit = 0;
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("memory,m", po::value<StateIdx>(&memory_limit), "memory limit in bytes")
+        ;
+    po::variables_map vm;
+    po::store(po::parse_command_line((Counter)argv.size(), argv.data(), desc), vm);
+    try {
+        po::notify(vm);
+    } catch (const po::required_option& e) {
+        std::cout << desc << std::endl;;
+        throw "";
+    }
+    return memory_limit;
+}
+
+double read_epsilon(std::vector<char*> argv)
+{
+    double epsilon = 0.001;
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("epsilon,e", po::value<double>(&epsilon), "relative error")
+        ;
+    po::variables_map vm;
+    po::store(po::parse_command_line((Counter)argv.size(), argv.data(), desc), vm);
+    try {
+        po::notify(vm);
+    } catch (const po::required_option& e) {
+        std::cout << desc << std::endl;;
+        throw "";
+    }
+    return epsilon;
+}
+
+std::string read_scratch_directory(std::vector<char*> argv)
+{
+    std::string scratch_directory = "";
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("scratch-directory,d", po::value<std::string>(&scratch_directory), "directory of the scratch files")
+        ;
+    po::variables_map vm;
+    po::store(po::parse_command_line((Counter)argv.size(), argv.data(), desc), vm);
+    try {
+        po::notify(vm);
+    } catch (const po::required_option& e) {
+        std::cout << desc << std::endl;;
+        throw "";
+    }
+    return scratch_directory;
+}
+
 MinknapOptionalParameters read_minknap_args(std::vector<char*> argv)
 {
     MinknapOptionalParameters p;
@@ -61,6 +137,8 @@ MinknapOptionalParameters read_minknap_args(std::vector<char*> argv)
         ("surrelax,s", po::value<StateIdx>(&p.surrelax), "")
         ("combo-core,c", "")
         ("partial-solution-size,k", po::value<ItemIdx>(&p.partial_solution_size), "")
+        ("threads,t", po::value<Counter>(&p.thread_number), "")
+        ("decision-trail,d", po::value<StateIdx>(&p.decision_trail_size), "")
         ;
     po::variables_map vm;
     po::store(po::parse_command_line((Counter)argv.size(), argv.data(), desc), vm);
@@ -76,7 +154,7 @@ MinknapOptionalParameters read_minknap_args(std::vector<char*> argv)
 }
 
 Output knapsacksolver::run(
-        std::string algorithm, Instance& instance, std::mt19937_64&, Info info)
+        std::string algorithm, Instance& instance, std::mt19937_64& gen, Info info)
 {
     std::vector<std::string> algorithm_args = po::split_unix(algorithm);
     std::vector<char*> algorithm_argv;
@@ -106,30 +184,83 @@ Output knapsacksolver::run(
         /*
          * Exact argsrithms
          */
-    } else if (algorithm_args[0] == "bellman_array") { // Bellman
+    } else if (algorithm_args[0].compare(0, 7, "bellman") == 0
+            && instance.gcd_weights() > 1) { // Bellman
+        // The capacity DPs are run on the instance with weights and capacity
+        // divided by the gcd of the weights, which is equivalent. On subset
+        // sum instances, the profits are divided too, so that the reduced
+        // instance is still a subset sum instance.
+        Output output(instance, info);
+        Weight g = instance.gcd_weights();
+        Profit g_profits = (instance.is_subsetsum())? g: 1;
+        // Item j of the reduced instance is the item at position j.
+        Instance instance_reduced;
+        for (ItemPos j = 0; j < instance.item_number(); ++j)
+            instance_reduced.add_item(instance.item(j).w / g, instance.item(j).p / g_profits);
+        instance_reduced.set_capacity(instance.capacity() / g);
+        Output output_reduced = run(algorithm, instance_reduced, gen, Info(info, false, ""));
+        Solution sol(instance);
+        for (ItemPos j = 0; j < instance.item_number(); ++j)
+            if (output_reduced.solution.contains_idx(j))
+                sol.set(j, true);
+        output.update_sol(sol, std::stringstream("gcd (lb)"), info);
+        output.update_lb(output_reduced.lower_bound * g_profits, std::stringstream("gcd (lb)"), info);
+        if (output_reduced.upper_bound != -1)
+            output.update_ub(output_reduced.upper_bound * g_profits, std::stringstream("gcd (ub)"), info);
+        return output.algorithm_end(info);
+    } else if (algorithm_args[0] == "bellman_bitset"
+            || (algorithm_args[0] == "bellman_array"
+                && instance.is_subsetsum())) {
+        // On subset sum instances, bellman_array only solves a reachability
+        // problem, for which the bitset DP is much faster. The other array
+        // DPs are run as requested.
+        return bellman_bitset(instance, info);
+    } else if (algorithm_args[0] == "bellman_array") {
         return bellman_array(instance, info);
     } else if (algorithm_args[0] == "bellmanpar_array") {
-        return bellmanpar_array(instance, info);
+        return bellmanpar_array(instance, read_thread_number(algorithm_argv), info);
+    } else if (algorithm_args[0] == "bellmanpar_array_capacity") {
+        return bellmanpar_array_capacity(instance, read_thread_number(algorithm_argv), info);
     } else if (algorithm_args[0] == "bellman_rec") {
         return bellmanrec(instance, info);
     } else if (algorithm_args[0] == "bellman_array_all") {
         return bellman_array_all(instance, info);
+    } else if (algorithm_args[0] == "bellman_array_bits") {
+        return bellman_array_bits(instance, info);
+    } else if (algorithm_args[0] == "bellman_array_file") {
+        return bellman_array_file(instance, read_scratch_directory(algorithm_argv), info);
+    } else if (algorithm_args[0] == "bellman_array_checkpoint") {
+        return bellman_array_checkpoint(instance, read_memory_limit(algorithm_argv), info);
+    } else if (algorithm_args[0] == "bellman_array_bounded") {
+        return bellman_array_bounded(instance, info);
     } else if (algorithm_args[0] == "bellman_array_one") {
         return bellman_array_one(instance, info);
     } else if (algorithm_args[0] == "bellman_array_part") {
         return bellman_array_part(instance, 64, info);
     } else if (algorithm_args[0] == "bellman_array_rec") {
         return bellman_array_rec(instance, info);
+    } else if (algorithm_args[0] == "bellmanpar_array_rec") {
+        return bellmanpar_array_rec(instance, read_thread_number(algorithm_argv),
+                BELLMANPAR_ARRAY_REC_MIN_SIZE, info);
     } else if (algorithm_args[0] == "bellman_list") {
         return bellman_list(instance, false, info);
     } else if (algorithm_args[0] == "bellman_list_sort") {
         return bellman_list(instance, true, info);
     } else if (algorithm_args[0] == "bellman_list_rec") {
         return bellman_list_rec(instance, info);
+    } else if (algorithm_args[0] == "bellmanpar_list_rec") {
+        return bellmanpar_list_rec(instance, read_thread_number(algorithm_argv),
+                BELLMANPAR_LIST_REC_MIN_SIZE, info);
     } else if (algorithm_args[0] == "dpprofits_array") { // DPProfits
         return dpprofits_array(instance, info);
     } else if (algorithm_args[0] == "dpprofits_array_all") {
         return dpprofits_array_all(instance, info);
+    } else if (algorithm_args[0] == "dpprofits_array_file") {
+        return dpprofits_array_file(instance, read_scratch_directory(algorithm_argv), info);
+    } else if (algorithm_args[0] == "dpprofitspar_array") {
+        return dpprofitspar_array(instance, read_thread_number(algorithm_argv), info);
+    } else if (algorithm_args[0] == "fptas") {
+        return fptas(instance, read_epsilon(algorithm_argv), info);
     } else if (algorithm_args[0] == "branchandbound") { // Branch-and-bound
         return branchandbound(instance, false, info);
     } else if (algorithm_args[0] == "branchandbound_sort") {
@@ -157,6 +288,7 @@ Output knapsacksolver::run(
     } else if (algorithm_args[0] == "minknap_combo" || algorithm_args[0] == "combo") {
         auto p = MinknapOptionalParameters().set_combo();
         p.info = info;
+        p.thread_number = read_thread_number(algorithm_argv, p.thread_number);
         return minknap(instance, p);
 
         /*
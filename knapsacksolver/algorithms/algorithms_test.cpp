@@ -0,0 +1,43 @@
+#include "knapsacksolver/algorithms/algorithms.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace knapsacksolver;
+
+TEST(run, GcdSubsetSum)
+{
+    // Subset sum instance whose weights have a gcd of 2.
+    std::mt19937_64 generator(0);
+    for (std::string algorithm: {
+            "bellman_bitset",
+            "bellman_array",
+            "bellman_array_all",
+            "bellman_list"}) {
+        Instance instance(21, {{4, 4}, {6, 6}, {10, 10}, {8, 8}});
+        Output output = run(algorithm, instance, generator, Info());
+        EXPECT_EQ(output.lower_bound, 20) << algorithm;
+        EXPECT_EQ(output.upper_bound, 20) << algorithm;
+        if (output.solution.item_number() > 0) {
+            EXPECT_EQ(output.solution.profit(), 20) << algorithm;
+        }
+    }
+}
+
+TEST(run, Gcd)
+{
+    // Instance whose weights have a gcd of 3.
+    std::mt19937_64 generator(0);
+    for (std::string algorithm: {
+            "bellman_array",
+            "bellman_array_all",
+            "bellman_list"}) {
+        Instance instance(23, {{6, 7}, {9, 8}, {15, 17}, {12, 14}});
+        Output output = run(algorithm, instance, generator, Info());
+        EXPECT_EQ(output.lower_bound, 24) << algorithm;
+        EXPECT_EQ(output.upper_bound, 24) << algorithm;
+        if (output.solution.item_number() > 0) {
+            EXPECT_EQ(output.solution.profit(), 24) << algorithm;
+            EXPECT_LE(output.solution.weight(), 23) << algorithm;
+        }
+    }
+}
@@ -11,12 +11,23 @@
 
 using namespace knapsacksolver;
 
+template <typename PartSol, typename Offset>
 void balknap_main(Instance& instance, BalknapOptionalParameters& p, BalknapOutput& output);
 
+template <typename PartSol>
+void balknap_main_typed(Instance& instance, BalknapOptionalParameters& p, BalknapOutput& output)
+{
+    switch (instance.state_offset_size()) {
+    case 4: balknap_main<PartSol, int32_t>(instance, p, output); break;
+    default: balknap_main<PartSol, int64_t>(instance, p, output); break;
+    }
+}
+
 BalknapOutput knapsacksolver::balknap(Instance& instance, BalknapOptionalParameters p)
 {
     VER(p.info, "*** balknap"
             << " -k " << p.partial_solution_size
+            << " -t " << p.thread_number
             << ((p.greedy)? " -g": "")
             << " -n " << p.greedynlogn
             << " -s " << p.surrelax
@@ -24,6 +35,7 @@ BalknapOutput knapsacksolver::balknap(Instance& instance, BalknapOptionalParamet
 
     LOG_FOLD_START(p.info, "*** balknap"
             << " -k " << p.partial_solution_size
+            << " -t " << p.thread_number
             << ((p.greedy)? " -g": "")
             << " -n " << p.greedynlogn
             << " -s " << p.surrelax
@@ -34,7 +46,15 @@ BalknapOutput knapsacksolver::balknap(Instance& instance, BalknapOptionalParamet
         p.end = &end;
 
     BalknapOutput output(instance, p.info);
-    balknap_main(instance, p, output);
+    p.partial_solution_size = std::min(p.partial_solution_size, PARTSOL_SIZE_MAX);
+    switch (partsol_word_size(p.partial_solution_size)) {
+    case 64: balknap_main_typed<uint64_t>(instance, p, output); break;
+#if defined(KNAPSACKSOLVER_PARTSOL_INT128)
+    case 128: balknap_main_typed<unsigned __int128>(instance, p, output); break;
+#endif
+    case 256: balknap_main_typed<std::bitset<256>>(instance, p, output); break;
+    default: balknap_main_typed<std::bitset<512>>(instance, p, output); break;
+    }
 
     LOG_FOLD_END(p.info, "balknap");
     return output.algorithm_end(p.info);
@@ -42,10 +62,16 @@ BalknapOutput knapsacksolver::balknap(Instance& instance, BalknapOptionalParamet
 
 /******************************************************************************/
 
+/**
+ * Weight and profit of a state, stored as offsets from the break solution
+ * (w_bar, p_bar), so that they fit in an Offset of 4 bytes if
+ * Instance::state_offset_size() == 4.
+ */
+template <typename Offset>
 struct BalknapState
 {
-    Weight mu;
-    Profit pi;
+    Offset mu;
+    Offset pi;
     bool operator()(const BalknapState& s1, const BalknapState& s2) const
     {
         if (s1.mu != s2.mu)
@@ -56,14 +82,19 @@ struct BalknapState
     }
 };
 
+template <typename PartSol>
 struct BalknapValue
 {
     ItemPos a;
     ItemPos a_prec;
-    PartSol1 sol;
+    PartSol sol;
 };
 
-std::ostream& operator<<(std::ostream& os, const std::pair<BalknapState, BalknapValue>& s)
+template <typename PartSol, typename Offset>
+using BalknapStateValue = std::pair<BalknapState<Offset>, BalknapValue<PartSol>>;
+
+template <typename PartSol, typename Offset>
+std::ostream& operator<<(std::ostream& os, const BalknapStateValue<PartSol, Offset>& s)
 {
     os
         << "(mu " << s.first.mu
@@ -75,6 +106,30 @@ std::ostream& operator<<(std::ostream& os, const std::pair<BalknapState, Balknap
     return os;
 }
 
+/**
+ * Result of the bounding and of the addition of item t for a range of the
+ * states which fit.
+ */
+template <typename PartSol, typename Offset>
+struct BalknapChunk
+{
+    /** Number of states kept by the bounding.  */
+    StateIdx size;
+    /** Largest upper bound of the states kept, -1 if none.  */
+    Profit ub;
+    /** Lower bound, updated with the states created by adding item t.  */
+    Profit lb;
+    /**
+     * true iff a state which fits and whose profit is greater than the lower
+     * bound has been created; best_state is then the last one.
+     */
+    bool improved;
+    BalknapStateValue<PartSol, Offset> best_state;
+    /** States created by adding item t, in decreasing order.  */
+    std::vector<BalknapStateValue<PartSol, Offset>> states_new;
+};
+
+template <typename PartSol, typename Offset>
 struct BalknapInternalData
 {
     BalknapInternalData(Instance& instance, BalknapOptionalParameters& p, BalknapOutput& output):
@@ -82,12 +137,157 @@ struct BalknapInternalData
     Instance& instance;
     BalknapOptionalParameters& p;
     BalknapOutput& output;
-    std::map<BalknapState, BalknapValue, BalknapState> map;
+    /** States sorted by increasing (mu, pi).  */
+    std::vector<BalknapStateValue<PartSol, Offset>> states;
+    /** Buffers used to rebuild states.  */
+    std::vector<BalknapStateValue<PartSol, Offset>> states_tmp;
+    std::vector<BalknapStateValue<PartSol, Offset>> states_new;
+    std::vector<BalknapStateValue<PartSol, Offset>> states_new_fit;
+    std::vector<BalknapStateValue<PartSol, Offset>> states_heap;
+    std::vector<BalknapChunk<PartSol, Offset>> chunks;
     std::vector<std::thread> threads;
 };
 
-void balknap_update_bounds(BalknapInternalData& d);
+template <typename PartSol, typename Offset>
+inline bool balknap_less(
+        const BalknapStateValue<PartSol, Offset>& s1,
+        const BalknapStateValue<PartSol, Offset>& s2)
+{
+    return BalknapState<Offset>()(s1.first, s2.first);
+}
+
+/**
+ * Add state s at the end of states, which must remain sorted. If the last
+ * state has the same weight and profit, keep the one with the largest a
+ * instead.
+ */
+template <typename PartSol, typename Offset>
+inline void balknap_push(
+        std::vector<BalknapStateValue<PartSol, Offset>>& states,
+        const BalknapStateValue<PartSol, Offset>& s)
+{
+    if (!states.empty()
+            && states.back().first.mu == s.first.mu
+            && states.back().first.pi == s.first.pi) {
+        if (states.back().second.a < s.second.a) {
+            states.back().second.a = s.second.a;
+            states.back().second.sol = s.second.sol;
+        }
+        return;
+    }
+    states.push_back(s);
+}
+
+/**
+ * Append to out the merge of the sorted ranges [first1, last1) and
+ * [first2, last2). When both contain a state, the one of the first range is
+ * kept, with the largest a.
+ */
+template <typename PartSol, typename Offset, typename It1, typename It2>
+void balknap_merge(It1 first1, It1 last1, It2 first2, It2 last2,
+        std::vector<BalknapStateValue<PartSol, Offset>>& out)
+{
+    while (first1 != last1 || first2 != last2) {
+        if (first2 == last2 || (first1 != last1 && !balknap_less(*first2, *first1))) {
+            balknap_push(out, *first1++);
+        } else {
+            balknap_push(out, *first2++);
+        }
+    }
+}
+
+/**
+ * Bound the states first..last-1 of d.states, which fit, and move the ones
+ * which are kept at the beginning of the range. Then, create the states
+ * obtained by adding item t to them.
+ *
+ * lb is only updated locally, so that the ranges can be processed in
+ * parallel.
+ */
+template <typename PartSol, typename Offset>
+void balknap_add_item_chunk(BalknapInternalData<PartSol, Offset>& d,
+        const PartSolFactory1<PartSol>& psolf, ItemPos t, Profit lb,
+        StateIdx first, StateIdx last, BalknapChunk<PartSol, Offset>& chunk)
+{
+    const Instance& instance = d.instance;
+    Weight c = instance.capacity();
+    ItemPos b = instance.break_item();
+    ItemPos f = instance.first_item();
+    Weight w_bar = instance.break_solution()->weight();
+    Profit p_bar = instance.break_solution()->profit();
+    Weight wt = instance.item(t).w;
+    Profit pt = instance.item(t).p;
+
+    // Bounding
+    chunk.ub = -1;
+    StateIdx k = first;
+    for (StateIdx i = first; i < last; ++i) {
+        const BalknapStateValue<PartSol, Offset>& s = d.states[i];
+        Profit pi = p_bar + s.first.pi;
+        Weight mu = w_bar + s.first.mu;
+        Profit ub_local = 0;
+        if (d.p.ub == 'b') {
+            ub_local = (mu <= c)?
+                ub_dembo(instance, b, pi, c-mu):
+                ub_dembo_rev(instance, b, pi, c-mu);
+        } else if (d.p.ub == 't') {
+            ub_local = (mu <= c)?
+                ub_dembo(instance, t, pi, c-mu):
+                ub_dembo_rev(instance, s.second.a, pi, c-mu);
+        }
+        if (ub_local < lb)
+            continue;
+        if (chunk.ub < ub_local)
+            chunk.ub = ub_local;
+        if (k != i)
+            d.states[k] = s;
+        k++;
+    }
+    chunk.size = k - first;
+
+    // Add item t
+    chunk.lb = lb;
+    chunk.improved = false;
+    chunk.states_new.clear();
+    for (StateIdx i = k - 1; i >= first; --i) {
+        const BalknapStateValue<PartSol, Offset>& s = d.states[i];
+        BalknapStateValue<PartSol, Offset> s1 = {
+            {(Offset)(s.first.mu + wt), (Offset)(s.first.pi + pt)},
+            {s.second.a, f, psolf.add(s.second.sol, t)}};
+        Weight mu_ = w_bar + s1.first.mu;
+        Profit pi_ = p_bar + s1.first.pi;
+
+        // Update LB
+        if (mu_ <= c && pi_ > chunk.lb) {
+            if (d.output.recursive_call_number == 1)
+                chunk.lb = pi_;
+            chunk.improved = true;
+            chunk.best_state = s1;
+            if (pi_ == d.output.upper_bound)
+                return;
+        }
+
+        // Bounding
+        Profit ub_local = 0;
+        if (d.p.ub == 'b') {
+            ub_local = (mu_ <= c)?
+                ub_dembo(instance, b, pi_, c-mu_):
+                ub_dembo_rev(instance, b, pi_, c-mu_);
+        } else if (d.p.ub == 't') {
+            ub_local = (mu_ <= c)?
+                ub_dembo(instance, t + 1, pi_, c-mu_):
+                ub_dembo_rev(instance, s.second.a - 1, pi_, c-mu_);
+        }
+        if (ub_local <= chunk.lb)
+            continue;
+        chunk.states_new.push_back(s1);
+    }
+}
+
+template <typename PartSol, typename Offset>
+void balknap_update_bounds(BalknapInternalData<PartSol, Offset>& d);
 
+template <typename PartSol, typename Offset>
 void balknap_main(Instance& instance, BalknapOptionalParameters& p, BalknapOutput& output)
 {
     Info& info = p.info;
@@ -197,16 +397,18 @@ void balknap_main(Instance& instance, BalknapOptionalParameters& p, BalknapOutpu
 
     // Initialization
     // Create first partial solution centered on the break item.
-    BalknapInternalData d(instance, p, output);
-    PartSolFactory1 psolf(instance, p.partial_solution_size, b, f, l);
-    PartSol1 psol_init = 0;
+    BalknapInternalData<PartSol, Offset> d(instance, p, output);
+    PartSolFactory1<PartSol> psolf(instance, p.partial_solution_size, b, f, l);
+    PartSol psol_init = PartSol();
     for (ItemPos j = f; j < b; ++j)
         psol_init = psolf.add(psol_init, j);
     // s(w_bar,p_bar) = b
-    d.map.insert({{w_bar, p_bar},{b, f, psol_init}});
+    d.states.push_back({{0, 0},{b, f, psol_init}});
+    // Capacity relative to w_bar.
+    Weight c_bar = c - w_bar;
 
     // Best state. Note that it is not a pointer
-    std::pair<BalknapState, BalknapValue> best_state = {d.map.begin()->first, d.map.begin()->second};
+    BalknapStateValue<PartSol, Offset> best_state = d.states.front();
     // Also keep last added item to improve the variable reduction at the end.
     ItemPos last_item = b-1;
 
@@ -214,7 +416,12 @@ void balknap_main(Instance& instance, BalknapOptionalParameters& p, BalknapOutpu
         d.output.lower_bound:
         d.output.lower_bound - 1;
 
-    // Recursion
+    // The states are stored in a sorted vector which is rebuilt at each
+    // iteration: the states which fit are filtered in place, then the states
+    // created by adding item t, which are generated in order, are merged in.
+    // The states created by removing items are processed in decreasing
+    // order of (mu, pi) with the ones which don't fit yet, so they go through
+    // a heap.
     for (ItemPos t = b; t <= l; ++t) {
         balknap_update_bounds(d);
         if (!p.info.check_time()) {
@@ -230,115 +437,144 @@ void balknap_main(Instance& instance, BalknapOptionalParameters& p, BalknapOutpu
             return;
         }
         if (output.solution.profit() == output.upper_bound
-                || best_state.first.pi == output.upper_bound)
+                || p_bar + best_state.first.pi == output.upper_bound)
             break;
 
         LOG(info, "t " << t << " (" << instance.item(t) << ")" << std::endl);
         Weight wt = instance.item(t).w;
-        Profit pt = instance.item(t).p;
 
-        // Bounding
-        LOG(info, "bound" << std::endl);
+        // Bounding and add item t
+        LOG(info, "bound and add" << std::endl);
+        StateIdx n_fit_old = std::partition_point(d.states.begin(), d.states.end(),
+                [c_bar](const BalknapStateValue<PartSol, Offset>& s) { return s.first.mu <= c_bar; })
+            - d.states.begin();
+        Counter chunk_number = (n_fit_old >= d.p.parallel_state_threshold)?
+            std::max((Counter)1, d.p.thread_number): 1;
+        d.chunks.resize(chunk_number);
+        std::vector<StateIdx> i_first(chunk_number + 1);
+        for (Counter k = 0; k <= chunk_number; ++k)
+            i_first[k] = n_fit_old * k / chunk_number;
+        auto add_item_chunk = [&d, &psolf, &i_first, t, lb](Counter k)
+        {
+            balknap_add_item_chunk(d, psolf, t, lb, i_first[k], i_first[k + 1], d.chunks[k]);
+        };
+        std::vector<std::thread> threads;
+        for (Counter k = 1; k < chunk_number; ++k)
+            threads.push_back(std::thread(add_item_chunk, k));
+        add_item_chunk(0);
+        for (std::thread& thread: threads)
+            thread.join();
+
         Profit ub_t = -1;
-        for (auto s = d.map.begin(); s != d.map.end() && s->first.mu <= c;) {
-            Profit pi = s->first.pi;
-            Weight mu = s->first.mu;
-            Profit ub_local = 0;
-            if (d.p.ub == 'b') {
-                ub_local = (mu <= c)?
-                    ub_dembo(instance, b, pi, c-mu):
-                    ub_dembo_rev(instance, b, pi, c-mu);
-            } else if (d.p.ub == 't') {
-                ub_local = (mu <= c)?
-                    ub_dembo(instance, t, pi, c-mu):
-                    ub_dembo_rev(instance, s->second.a, pi, c-mu);
-            }
-            if (ub_local < lb) {
-                LOG(info, "remove " << *s << std::endl);
-                d.map.erase(s++);
-            } else {
-                if (ub_t < ub_local)
-                    ub_t = ub_local;
-                s++;
-            }
+        StateIdx n_fit = 0;
+        for (Counter k = 0; k < chunk_number; ++k) {
+            ub_t = std::max(ub_t, d.chunks[k].ub);
+            if (n_fit != i_first[k])
+                std::copy(d.states.begin() + i_first[k],
+                        d.states.begin() + i_first[k] + d.chunks[k].size,
+                        d.states.begin() + n_fit);
+            n_fit += d.chunks[k].size;
         }
+        d.states.erase(d.states.begin() + n_fit, d.states.begin() + n_fit_old);
         if (ub_t != -1 && output.upper_bound > ub_t) {
             std::stringstream ss;
             ss << "it " << t - b << " (ub)";
             output.update_ub(ub_t, ss, info);
             if (output.solution.profit() == output.upper_bound
-                    || best_state.first.pi == output.upper_bound)
+                    || p_bar + best_state.first.pi == output.upper_bound)
                 goto end;
         }
 
         // If there is no more states, the stop
-        if (d.map.size() == 0)
+        if (d.states.size() == 0)
             break;
-        if (best_state.first.pi == output.upper_bound)
+        if (p_bar + best_state.first.pi == output.upper_bound)
             goto end;
         if (p.stop_if_end && *(p.end)) {
             LOG_FOLD_END(p.info, "end");
             return;
         }
 
-        // Add item t
-        LOG(info, "add" << std::endl);
-        auto s = d.map.upper_bound({c+1,0});
-        auto hint = s;
-        hint--;
-        while (s != d.map.begin() && (--s)->first.mu <= c) {
-            std::pair<BalknapState, BalknapValue> s1 = {
-                {s->first.mu + wt, s->first.pi + pt},
-                {s->second.a, f, psolf.add(s->second.sol, t)}};
-            LOG(info, s1);
-            Weight mu_ = s1.first.mu;
-            Profit pi_ = s1.first.pi;
-
-            // Update LB
-            if (mu_ <= c && pi_ > lb) {
+        // Update LB
+        {
+            Counter k_best = -1;
+            for (Counter k = 0; k < chunk_number; ++k)
+                if (d.chunks[k].improved && (k_best == -1
+                            || d.chunks[k].best_state.first.pi
+                            > d.chunks[k_best].best_state.first.pi))
+                    k_best = k;
+            if (k_best != -1) {
+                best_state = d.chunks[k_best].best_state;
+                last_item = t;
                 if (d.output.recursive_call_number == 1) {
                     std::stringstream ss;
                     ss << "it " << t - b << " (lb)";
-                    output.update_lb(pi_, ss, info);
-                    lb = pi_;
+                    output.update_lb(p_bar + best_state.first.pi, ss, info);
+                    lb = p_bar + best_state.first.pi;
                 }
-                best_state = s1;
-                last_item = t;
-                if (best_state.first.pi == output.upper_bound)
+                if (p_bar + best_state.first.pi == output.upper_bound)
                     goto end;
             }
-
-            // Bounding
-            Profit ub_local = 0;
-            if (d.p.ub == 'b') {
-                ub_local = (mu_ <= c)?
-                    ub_dembo(instance, b, pi_, c-mu_):
-                    ub_dembo_rev(instance, b, pi_, c-mu_);
-            } else if (d.p.ub == 't') {
-                ub_local = (mu_ <= c)?
-                    ub_dembo(instance, t + 1, pi_, c-mu_):
-                    ub_dembo_rev(instance, s->second.a - 1, pi_, c-mu_);
-            }
-            if (ub_local <= lb) {
-                LOG(info, " ×" << std::endl);
-                continue;
-            }
-
-            LOG(info, " ok" << std::endl);
-            hint = d.map.insert(hint, s1);
-            if (hint->second.a < s->second.a) {
-                hint->second.a = s->second.a;
-                hint->second.sol = psolf.add(s->second.sol, t);
-            }
-            hint--;
         }
 
+        // Merge the states created by adding item t. The ones of a range are
+        // all lighter than the ones of the next range.
+        d.states_new.clear();
+        for (Counter k = 0; k < chunk_number; ++k)
+            d.states_new.insert(d.states_new.end(),
+                    d.chunks[k].states_new.rbegin(), d.chunks[k].states_new.rend());
+        d.states_tmp.clear();
+        balknap_merge(d.states.begin(), d.states.end(),
+                d.states_new.begin(), d.states_new.end(), d.states_tmp);
+        std::swap(d.states, d.states_tmp);
+
         // Remove previously added items
         LOG(info, "remove" << std::endl);
-        for (auto s = d.map.rbegin(); s != d.map.rend() && s->first.mu > c; ++s) {
-            if (s->first.mu > c + wt)
+        // States which fit, created by removing an item.
+        d.states_new_fit.clear();
+        // States which don't fit, created by removing an item, and not
+        // processed yet. Since they are lighter than the state they come
+        // from, they are processed later in the same loop.
+        d.states_heap.clear();
+        // States which don't fit and have been processed, in decreasing
+        // order.
+        d.states_new.clear();
+        n_fit = std::partition_point(d.states.begin(), d.states.end(),
+                [c_bar](const BalknapStateValue<PartSol, Offset>& s) { return s.first.mu <= c_bar; })
+            - d.states.begin();
+        StateIdx n_skip = std::partition_point(d.states.begin() + n_fit, d.states.end(),
+                [c_bar, wt](const BalknapStateValue<PartSol, Offset>& s) { return s.first.mu <= c_bar + wt; })
+            - d.states.begin();
+        bool process = true;
+        for (StateIdx i = n_skip - 1; i >= n_fit || !d.states_heap.empty();) {
+            // Next state in decreasing order. A state of the heap may be
+            // equal to a state of d.states, or to other states of the heap.
+            BalknapStateValue<PartSol, Offset> s;
+            if (d.states_heap.empty() || (i >= n_fit
+                        && !balknap_less(d.states[i], d.states_heap.front()))) {
+                s = d.states[i--];
+            } else {
+                std::pop_heap(d.states_heap.begin(), d.states_heap.end(),
+                        balknap_less<PartSol, Offset>);
+                s = d.states_heap.back();
+                d.states_heap.pop_back();
+            }
+            while (!d.states_heap.empty()
+                    && d.states_heap.front().first.mu == s.first.mu
+                    && d.states_heap.front().first.pi == s.first.pi) {
+                if (s.second.a < d.states_heap.front().second.a) {
+                    s.second.a = d.states_heap.front().second.a;
+                    s.second.sol = d.states_heap.front().second.sol;
+                }
+                std::pop_heap(d.states_heap.begin(), d.states_heap.end(),
+                        balknap_less<PartSol, Offset>);
+                d.states_heap.pop_back();
+            }
+            if (!process) {
+                d.states_new.push_back(s);
                 continue;
-            LOG(info, *s << std::endl);
+            }
+            LOG(info, s << std::endl);
 
             balknap_update_bounds(d);
             if (!p.info.check_time()) {
@@ -354,16 +590,19 @@ void balknap_main(Instance& instance, BalknapOptionalParameters& p, BalknapOutpu
                 return;
             }
             if (output.solution.profit() == output.upper_bound
-                    || best_state.first.pi == output.upper_bound)
-                break;
+                    || p_bar + best_state.first.pi == output.upper_bound) {
+                process = false;
+                d.states_new.push_back(s);
+                continue;
+            }
 
-            for (ItemPos j = s->second.a_prec; j < s->second.a; ++j) {
+            for (ItemPos j = s.second.a_prec; j < s.second.a; ++j) {
                 LOG(info, "j " << j);
-                Weight mu_ = s->first.mu - instance.item(j).w;
-                Profit pi_ = s->first.pi - instance.item(j).p;
-                std::pair<BalknapState, BalknapValue> s1 = {
-                    {mu_, pi_},
-                    {j, f, psolf.remove(s->second.sol, j)}};
+                Weight mu_ = w_bar + s.first.mu - instance.item(j).w;
+                Profit pi_ = p_bar + s.first.pi - instance.item(j).p;
+                BalknapStateValue<PartSol, Offset> s1 = {
+                    {(Offset)(mu_ - w_bar), (Offset)(pi_ - p_bar)},
+                    {j, f, psolf.remove(s.second.sol, j)}};
 
                 // Update LB
                 if (mu_ <= c && pi_ > lb) {
@@ -375,7 +614,7 @@ void balknap_main(Instance& instance, BalknapOptionalParameters& p, BalknapOutpu
                     }
                     best_state = s1;
                     last_item = t;
-                    if (best_state.first.pi == output.upper_bound)
+                    if (p_bar + best_state.first.pi == output.upper_bound)
                         goto end;
                 }
 
@@ -396,17 +635,25 @@ void balknap_main(Instance& instance, BalknapOptionalParameters& p, BalknapOutpu
                 }
 
                 LOG(info, " ok" << std::endl);
-                auto res = d.map.insert(s1);
-                if (!res.second) {
-                    if (res.first->second.a < j) {
-                        res.first->second.a = j;
-                        res.first->second.sol = psolf.remove(s->second.sol, j);
-                    }
+                if (s1.first.mu <= c_bar) {
+                    d.states_new_fit.push_back(s1);
+                } else {
+                    d.states_heap.push_back(s1);
+                    std::push_heap(d.states_heap.begin(), d.states_heap.end(),
+                            balknap_less<PartSol, Offset>);
                 }
             }
-            s->second.a_prec = s->second.a;
+            s.second.a_prec = s.second.a;
+            d.states_new.push_back(s);
         }
-
+        std::sort(d.states_new_fit.begin(), d.states_new_fit.end(),
+                balknap_less<PartSol, Offset>);
+        d.states_tmp.clear();
+        balknap_merge(d.states.begin(), d.states.begin() + n_fit,
+                d.states_new_fit.begin(), d.states_new_fit.end(), d.states_tmp);
+        d.states_tmp.insert(d.states_tmp.end(), d.states_new.rbegin(), d.states_new.rend());
+        d.states_tmp.insert(d.states_tmp.end(), d.states.begin() + n_skip, d.states.end());
+        std::swap(d.states, d.states_tmp);
     }
 end:
     output.update_ub(output.lower_bound, std::stringstream("tree search completed"), p.info);
@@ -423,7 +670,7 @@ end:
         return;
 
     LOG(info, "best_state " << best_state << std::endl);
-    LOG(info, "partial sol " << std::bitset<64>(best_state.second.sol) << std::endl);
+    LOG(info, "partial sol " << psolf.print(best_state.second.sol) << std::endl);
 
     // Reduce instance to items from best_state.second.a to last_item and remove
     // the items from the partial solution from the instance.
@@ -433,17 +680,18 @@ end:
     instance.fix(info, psolf.vector(best_state.second.sol));
 
     LOG_FOLD_END(info, "balknap_main");
-    balknap_main(instance, p, output);
+    balknap_main<PartSol, Offset>(instance, p, output);
 }
 
 /******************************************************************************/
 
-void balknap_update_bounds(BalknapInternalData& d)
+template <typename PartSol, typename Offset>
+void balknap_update_bounds(BalknapInternalData<PartSol, Offset>& d)
 {
     Instance& instance = d.instance;
     Info& info = d.p.info;
 
-    if (d.p.surrelax >= 0 && d.p.surrelax <= (StateIdx)d.map.size()) {
+    if (d.p.surrelax >= 0 && d.p.surrelax <= (StateIdx)d.states.size()) {
         d.p.surrelax = -1;
         std::function<Output (Instance&, Info, bool*)> func
             = [&d](Instance& instance, Info info, bool* end)
@@ -466,7 +714,7 @@ void balknap_update_bounds(BalknapInternalData& d)
                     .end      = d.p.end,
                     .info     = Info(info, true, "surrelax")}));
     }
-    if (d.p.greedynlogn >= 0 && d.p.greedynlogn <= (StateIdx)d.map.size()) {
+    if (d.p.greedynlogn >= 0 && d.p.greedynlogn <= (StateIdx)d.states.size()) {
         d.p.greedynlogn = -1;
         auto gn_output = greedynlogn(d.instance);
         d.output.update_sol(gn_output.solution, std::stringstream("greedynlogn"), d.p.info);
@@ -4,7 +4,6 @@
 #include "knapsacksolver/part_solution_1.hpp"
 
 #include <thread>
-#include <map>
 
 namespace knapsacksolver
 {
@@ -19,6 +18,12 @@ struct BalknapOptionalParameters
     StateIdx surrelax = -1;
     ItemPos partial_solution_size = 64;
 
+    // At each item, if there are at least "parallel_state_threshold" states
+    // which fit, they are split into "thread_number" ranges of mu which are
+    // bounded and extended with the item in parallel.
+    Counter thread_number = 1;
+    StateIdx parallel_state_threshold = 1 << 14;
+
     bool* end = NULL;
     bool stop_if_end = false;
     bool set_end = true;
@@ -85,6 +85,43 @@ Output balknap_3_t_test(Instance& ins)
     return balknap(ins, p);
 }
 
+Output balknap_128_t_test(Instance& ins)
+{
+    Info info = Info()
+        .set_verbose(true)
+        ;
+    BalknapOptionalParameters p;
+    p.info = info;
+    p.ub = 't';
+    p.partial_solution_size = 128;
+    return balknap(ins, p);
+}
+
+Output balknap_512_b_test(Instance& ins)
+{
+    Info info = Info()
+        .set_verbose(true)
+        ;
+    BalknapOptionalParameters p;
+    p.info = info;
+    p.ub = 'b';
+    p.partial_solution_size = 512;
+    return balknap(ins, p);
+}
+
+Output balknap_parallel_test(Instance& ins)
+{
+    Info info = Info()
+        .set_verbose(true)
+        ;
+    BalknapOptionalParameters p;
+    p.info = info;
+    p.ub = 't';
+    p.thread_number = 3;
+    p.parallel_state_threshold = 0;
+    return balknap(ins, p);
+}
+
 std::vector<Output (*)(Instance&)> f = {
         minknap_test,
         balknap_1_b_test,
@@ -93,8 +130,25 @@ std::vector<Output (*)(Instance&)> f = {
         balknap_1_t_test,
         balknap_2_t_test,
         balknap_3_t_test,
+        balknap_128_t_test,
+        balknap_512_b_test,
+        balknap_parallel_test,
 };
 
 TEST(balknap, TEST)  { test(TEST, f, SOPT); }
 TEST(balknap, SMALL) { test(SMALL, f, SOPT); }
 
+TEST(balknap, LARGE_COEFFICIENTS)
+{
+    // The sums of the weights and of the profits don't fit in 32 bits.
+    Weight k = (Weight)1 << 28;
+    Instance instance(5 * k, {
+            {3 * k, 4 * k},
+            {4 * k, 5 * k},
+            {2 * k, 3 * k}});
+    EXPECT_EQ(instance.state_offset_size(), 8);
+    Output output = balknap(instance, BalknapOptionalParameters());
+    EXPECT_EQ(output.lower_bound, 7 * k);
+    EXPECT_EQ(output.solution.profit(), 7 * k);
+}
+
@@ -1,11 +1,15 @@
 #include "knapsacksolver/algorithms/bellman.hpp"
 
 #include "knapsacksolver/part_solution_1.hpp"
+#include "knapsacksolver/parallel.hpp"
 #include "knapsacksolver/algorithms/dembo.hpp"
 #include "knapsacksolver/algorithms/dantzig.hpp"
 #include "knapsacksolver/algorithms/greedynlogn.hpp"
+#include "knapsacksolver/algorithms/dpkernels.hpp"
+#include "knapsacksolver/algorithms/dpfile.hpp"
 
 #include <thread>
+#include <cmath>
 
 using namespace knapsacksolver;
 
@@ -13,12 +17,87 @@ using namespace knapsacksolver;
 
 /******************************* bellman_array ********************************/
 
-Output knapsacksolver::bellman_array(const Instance& instance, Info info)
+/** Upper bound on the values of the capacity DP tables.  */
+Profit bellman_array_value_bound(const Instance& instance)
+{
+    Profit bound = 0;
+    for (ItemPos j = 0; j < instance.item_number(); ++j)
+        if (instance.item(j).w <= instance.capacity())
+            bound += instance.item(j).p;
+    return bound;
+}
+
+/**
+ * Number of items applied at once by the cache-blocked kernel, 1 if the
+ * table is small enough to stay in cache or if the weights are too large.
+ */
+template <typename T>
+ItemIdx bellman_array_block_size(const Instance& instance)
+{
+    Weight c = instance.capacity();
+    if ((c + 1) * (StateIdx)sizeof(T) <= BELLMAN_ARRAY_BLOCK_BYTES)
+        return 1;
+    Weight w_max = 0;
+    for (ItemPos j = 0; j < instance.item_number(); ++j)
+        if (instance.item(j).w <= c)
+            w_max = std::max(w_max, instance.item(j).w);
+    StateIdx ring_size = w_max + 2 * BELLMAN_ARRAY_TILE_SIZE;
+    return std::max((StateIdx)1, std::min((StateIdx)64,
+                BELLMAN_ARRAY_BLOCK_BYTES / (ring_size * (StateIdx)sizeof(T))));
+}
+
+template <typename T>
+Output bellman_array_tiled(const Instance& instance, ItemIdx block_size, Info& info)
 {
-    VER(info, "*** bellman (array) ***" << std::endl);
     Output output(instance, info);
     Weight c = instance.capacity();
-    std::vector<Profit> values(c + 1, 0);
+    std::vector<T> values(c + 1, 0);
+    std::vector<T> buffer;
+    std::vector<Weight> w;
+    std::vector<T> p;
+    ItemPos j = 0;
+    while (j < instance.item_number()) {
+        // Check time
+        if (!info.check_time())
+            return output.algorithm_end(info);
+
+        // Update DP table with the next block_size items fitting in the
+        // knapsack
+        w.clear();
+        p.clear();
+        for (; j < instance.item_number() && (ItemIdx)w.size() < block_size; ++j) {
+            if (instance.item(j).w <= c) {
+                w.push_back(instance.item(j).w);
+                p.push_back(instance.item(j).p);
+            }
+        }
+        if (!w.empty())
+            bellman_array_update_tiled(values.data(), c, w.data(), p.data(), w.size(), buffer);
+
+        // Update lower bound
+        if (output.lower_bound < values[c]) {
+            std::stringstream ss;
+            ss << "it " << j - 1;
+            output.update_lb(values[c], ss, info);
+        }
+    }
+
+    // Update upper bound
+    output.update_ub(values[c], std::stringstream("tree search completed"), info);
+
+    return output.algorithm_end(info);
+}
+
+template <typename T>
+Output bellman_array_typed(const Instance& instance, Info& info)
+{
+    ItemIdx block_size = bellman_array_block_size<T>(instance);
+    if (block_size > 1)
+        return bellman_array_tiled<T>(instance, block_size, info);
+
+    Output output(instance, info);
+    Weight c = instance.capacity();
+    std::vector<T> values(c + 1, 0);
     for (ItemPos j = 0; j < instance.item_number(); ++j) {
         // Check time
         if (!info.check_time())
@@ -26,10 +105,9 @@ Output knapsacksolver::bellman_array(const Instance& instance, Info info)
 
         // Update DP table
         Weight wj = instance.item(j).w;
-        Profit pj = instance.item(j).p;
-        for (Weight w = c; w >= wj; w--)
-            if (values[w] < values[w - wj] + pj)
-                values[w] = values[w - wj] + pj;
+        T pj = instance.item(j).p;
+        if (wj <= c)
+            bellman_array_update(&values[wj], &values[0], &values[wj], c - wj + 1, pj);
 
         // Update lower bound
         if (output.lower_bound < values[c]) {
@@ -45,6 +123,136 @@ Output knapsacksolver::bellman_array(const Instance& instance, Info info)
     return output.algorithm_end(info);
 }
 
+Output knapsacksolver::bellman_array(const Instance& instance, Info info)
+{
+    VER(info, "*** bellman (array) ***" << std::endl);
+    switch (dp_value_size(bellman_array_value_bound(instance))) {
+    case 2: return bellman_array_typed<int16_t>(instance, info);
+    case 4: return bellman_array_typed<int32_t>(instance, info);
+    default: return bellman_array_typed<int64_t>(instance, info);
+    }
+}
+
+/******************************* bellman_bitset *******************************/
+
+/** Position of the highest set bit of a non-zero word. */
+inline Weight bellman_bitset_highest_bit(uint64_t word)
+{
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(word);
+#else
+    Weight k = 0;
+    while (word >>= 1)
+        k++;
+    return k;
+#endif
+}
+
+struct BellmanBitsetRecord
+{
+    /** Index of the word of the bitset. */
+    StateIdx word;
+    /** Bits set by the item in this word. */
+    uint64_t bits;
+};
+
+Output knapsacksolver::bellman_bitset(const Instance& instance, Info info)
+{
+    VER(info, "*** bellman (bitset) ***" << std::endl);
+    assert(instance.is_subsetsum());
+    Output output(instance, info);
+    ItemPos n = instance.item_number();
+    Weight  c = instance.capacity();
+
+    // Bit w of the bitset is set iff a subset of the items considered so far
+    // has weight w. Bits greater than c are never set.
+    StateIdx word_number = c / 64 + 1;
+    uint64_t last_mask = (c % 64 == 63)? ~(uint64_t)0: ((uint64_t)1 << (c % 64 + 1)) - 1;
+    std::vector<uint64_t> bitset(word_number, 0);
+    bitset[0] = 1;
+
+    // The bits set by item j are stored in records[record_first[j]],
+    // ..., records[record_first[j + 1] - 1], by decreasing word index. Each
+    // bit is set by exactly one item, so these records are enough to
+    // retrieve an optimal solution.
+    std::vector<BellmanBitsetRecord> records;
+    std::vector<StateIdx> record_first(n + 1, 0);
+
+    Weight opt = 0;
+    ItemPos j_last = n;
+    for (ItemPos j = 0; j < n; ++j) {
+        // Check time
+        if (!info.check_time())
+            return output.algorithm_end(info);
+
+        record_first[j] = records.size();
+        Weight wj = instance.item(j).w;
+        if (wj <= c) {
+            // bitset |= bitset << wj, from the last word to the first one, so
+            // that each word is read before being overwritten.
+            StateIdx q = wj / 64;
+            Weight   r = wj % 64;
+            for (StateIdx i = word_number - 1; i >= q; --i) {
+                uint64_t shifted = bitset[i - q] << r;
+                if (r != 0 && i - q >= 1)
+                    shifted |= bitset[i - q - 1] >> (64 - r);
+                if (i == word_number - 1)
+                    shifted &= last_mask;
+                uint64_t bits = shifted & ~bitset[i];
+                if (bits != 0) {
+                    bitset[i] |= bits;
+                    records.push_back({i, bits});
+                }
+            }
+        }
+        record_first[j + 1] = records.size();
+
+        // Update lower bound
+        if (record_first[j + 1] > record_first[j]) {
+            const BellmanBitsetRecord& record = records[record_first[j]];
+            Weight w = record.word * 64 + bellman_bitset_highest_bit(record.bits);
+            if (opt < w) {
+                opt = w;
+                std::stringstream ss;
+                ss << "it " << j;
+                output.update_lb(opt, ss, info);
+            }
+        }
+
+        // Stop if the capacity is reached
+        if (opt == c) {
+            j_last = j + 1;
+            break;
+        }
+    }
+
+    // Retrieve optimal solution
+    Solution sol(instance);
+    Weight w = opt;
+    for (ItemPos j = j_last - 1; w > 0; --j) {
+        // Find the record of item j containing bit w, if any.
+        StateIdx i = w / 64;
+        auto it = std::lower_bound(
+                records.begin() + record_first[j],
+                records.begin() + record_first[j + 1],
+                i,
+                [](const BellmanBitsetRecord& record, StateIdx i) { return record.word > i; });
+        if (it != records.begin() + record_first[j + 1]
+                && it->word == i
+                && ((it->bits >> (w % 64)) & 1)) {
+            sol.set(j, true);
+            w -= instance.item(j).w;
+        }
+    }
+    assert(sol.profit() == opt);
+    output.update_sol(sol, std::stringstream(""), info);
+
+    // Update upper bound
+    output.update_ub(opt, std::stringstream("tree search completed"), info);
+
+    return output.algorithm_end(info);
+}
+
 /****************************** bellmanpar_array ******************************/
 
 void bellmanpar_array_worker(const Instance& instance, ItemPos n1, ItemPos n2,
@@ -55,49 +263,313 @@ void bellmanpar_array_worker(const Instance& instance, ItemPos n1, ItemPos n2,
             return;
         Weight wj = instance.item(j).w;
         Profit pj = instance.item(j).p;
-        for (Weight w = instance.capacity(); w >= wj; w--)
-            if (*(values + w) < *(values + w - wj) + pj)
-                *(values + w) = *(values + w - wj) + pj;
+        Weight c = instance.capacity();
+        if (wj <= c)
+            bellman_array_update(&values[wj], &values[0], &values[wj], c - wj + 1, pj);
+    }
+}
+
+void bellman_array_rec_solve(const Instance& instance,
+        ItemPos n1, ItemPos n2, Weight c, Solution& sol, Info& info);
+
+struct BellmanparArrayNode
+{
+    /** Partitions n1, ..., n2 - 1 are merged in this node. */
+    Counter n1;
+    Counter n2;
+    /** Children, -1 for leaves. */
+    Counter left;
+    Counter right;
+    /** Values of the node, empty for the root. */
+    std::vector<Profit> values;
+};
+
+void bellmanpar_array_merge_worker(
+        const std::vector<Profit>& values_1,
+        const std::vector<Weight>& breakpoints,
+        const std::vector<Profit>& values_2,
+        std::vector<Profit>& values,
+        Weight w_first, Weight w_last)
+{
+    for (Weight w = w_first; w <= w_last; ++w) {
+        Profit z_max = -1;
+        for (Weight w1: breakpoints) {
+            if (w1 > w)
+                break;
+            Profit z = values_1[w1] + values_2[w - w1];
+            if (z_max < z)
+                z_max = z;
+        }
+        values[w] = z_max;
+    }
+}
+
+/**
+ * Compute values[w] = max_{w1 <= w} values_1[w1] + values_2[w - w1].
+ *
+ * Since values_1 is non-decreasing, only the capacities w1 at which it
+ * increases need to be considered. The capacities are split between the
+ * threads.
+ */
+void bellmanpar_array_merge(
+        const std::vector<Profit>& values_1,
+        const std::vector<Profit>& values_2,
+        std::vector<Profit>& values,
+        Counter thread_number)
+{
+    Weight c = values_1.size() - 1;
+    std::vector<Weight> breakpoints_1 {0};
+    std::vector<Weight> breakpoints_2 {0};
+    for (Weight w = 1; w <= c; ++w) {
+        if (values_1[w] != values_1[w - 1])
+            breakpoints_1.push_back(w);
+        if (values_2[w] != values_2[w - 1])
+            breakpoints_2.push_back(w);
+    }
+    bool swap = (breakpoints_2.size() < breakpoints_1.size());
+    const std::vector<Profit>& v1 = (swap)? values_2: values_1;
+    const std::vector<Profit>& v2 = (swap)? values_1: values_2;
+    const std::vector<Weight>& breakpoints = (swap)? breakpoints_2: breakpoints_1;
+
+    values.resize(c + 1);
+    Weight block_size = (c + thread_number) / thread_number;
+    std::vector<std::thread> threads;
+    for (Counter thread_id = 1; thread_id < thread_number; ++thread_id)
+        threads.push_back(std::thread(bellmanpar_array_merge_worker,
+                    std::ref(v1), std::ref(breakpoints), std::ref(v2), std::ref(values),
+                    thread_id * block_size,
+                    std::min(c, (thread_id + 1) * block_size - 1)));
+    bellmanpar_array_merge_worker(v1, breakpoints, v2, values,
+            0, std::min(c, block_size - 1));
+    for (std::thread& thread: threads)
+        thread.join();
+}
+
+Counter bellmanpar_array_tree(
+        std::vector<BellmanparArrayNode>& nodes,
+        std::vector<std::vector<Profit>>& values_partitions,
+        Counter n1, Counter n2, Counter thread_number, bool root)
+{
+    if (n2 - n1 == 1) {
+        nodes.push_back({n1, n2, -1, -1, {}});
+        nodes.back().values.swap(values_partitions[n1]);
+        return nodes.size() - 1;
+    }
+    Counter k = (n1 + n2 - 1) / 2 + 1;
+    Counter left  = bellmanpar_array_tree(nodes, values_partitions, n1, k, thread_number, false);
+    Counter right = bellmanpar_array_tree(nodes, values_partitions, k, n2, thread_number, false);
+    nodes.push_back({n1, n2, left, right, {}});
+    if (!root)
+        bellmanpar_array_merge(
+                nodes[left].values,
+                nodes[right].values,
+                nodes.back().values,
+                thread_number);
+    return nodes.size() - 1;
+}
+
+/**
+ * Find the best split of capacity c between the two children of a node.
+ */
+Weight bellmanpar_array_split(
+        const std::vector<Profit>& values_1,
+        const std::vector<Profit>& values_2,
+        Weight c)
+{
+    Profit z_max = -1;
+    Weight c1_opt = 0;
+    for (Weight c1 = 0; c1 <= c; ++c1) {
+        Profit z = values_1[c1] + values_2[c - c1];
+        if (z_max < z) {
+            z_max = z;
+            c1_opt = c1;
+        }
     }
+    return c1_opt;
 }
 
-Output knapsacksolver::bellmanpar_array(const Instance& instance, Info info)
+Output knapsacksolver::bellmanpar_array(
+        const Instance& instance, Counter partition_number, Info info)
 {
-    VER(info, "*** bellmanpar (array) ***" << std::endl);
+    VER(info, "*** bellmanpar (array, " << partition_number << " partitions) ***" << std::endl);
     Output output(instance, info);
     ItemIdx n = instance.item_number();
+    Weight  c = instance.capacity();
 
     // Trivial cases
     if (n == 0) {
         output.update_ub(0, std::stringstream("no item"), info);
         return output.algorithm_end(info);
     } else if (n == 1) {
-        output.update_lb(instance.item(0).p, std::stringstream("one item"), info);
-        output.update_ub(instance.item(0).p, std::stringstream(""), info);
+        Solution sol(instance);
+        if (instance.item(0).w <= c)
+            sol.set(0, true);
+        output.update_sol(sol, std::stringstream("one item (lb)"), info);
+        output.update_ub(sol.profit(), std::stringstream("one item (ub)"), info);
         return output.algorithm_end(info);
     }
 
-    // Partition items and solve both knapsacks
-    Weight c = instance.capacity();
-    ItemIdx k = (n - 1) / 2 + 1;
-    std::vector<Profit> values1(c + 1, 0);
-    std::thread thread(bellmanpar_array_worker, std::ref(instance), 0, k, values1.begin(), info);
-    std::vector<Profit> values2(c + 1, 0);
-    bellmanpar_array_worker(std::ref(instance), k, n, values2.begin(), info);
-    thread.join();
+    // Partition items and solve each knapsack on its own thread
+    Counter m = std::max((Counter)1, std::min(partition_number, n));
+    std::vector<ItemPos> bounds(m + 1);
+    for (Counter i = 0; i <= m; ++i)
+        bounds[i] = (i * n) / m;
+    std::vector<std::vector<Profit>> values_partitions(m, std::vector<Profit>(c + 1, 0));
+    std::vector<std::thread> threads;
+    for (Counter i = 1; i < m; ++i)
+        threads.push_back(std::thread(bellmanpar_array_worker, std::ref(instance),
+                    bounds[i], bounds[i + 1], values_partitions[i].begin(), info));
+    bellmanpar_array_worker(instance, bounds[0], bounds[1], values_partitions[0].begin(), info);
+    for (std::thread& thread: threads)
+        thread.join();
     if (!info.check_time())
         return output.algorithm_end(info);
 
-    // Compute optimum
-    Profit opt = -1;
-    for (Weight c1 = 0; c1 <= c; ++c1) {
-        Profit z = values1[c1] + values2[c - c1];
-        if (opt < z)
-            opt = z;
-    }
+    // Merge the partitions two by two. Only the value of capacity c is
+    // needed at the root.
+    std::vector<BellmanparArrayNode> nodes;
+    Counter root = bellmanpar_array_tree(nodes, values_partitions, 0, m, m, true);
+    if (!info.check_time())
+        return output.algorithm_end(info);
 
+    // Compute optimum and the capacity of each partition
+    std::vector<Weight> capacities(nodes.size(), 0);
+    capacities[root] = c;
+    for (Counter node_id = root; node_id >= 0; --node_id) {
+        const BellmanparArrayNode& node = nodes[node_id];
+        if (node.left == -1)
+            continue;
+        Weight c1 = bellmanpar_array_split(
+                nodes[node.left].values,
+                nodes[node.right].values,
+                capacities[node_id]);
+        capacities[node.left]  = c1;
+        capacities[node.right] = capacities[node_id] - c1;
+    }
+    Profit opt = 0;
+    for (Counter node_id = 0; node_id <= root; ++node_id)
+        if (nodes[node_id].left == -1)
+            opt += nodes[node_id].values[capacities[node_id]];
     output.update_lb(opt, std::stringstream("tree search completed (lb)"), info);
     output.update_ub(opt, std::stringstream("tree search completed (ub)"), info);
+
+    // Retrieve optimal solution by solving each partition with its capacity
+    std::vector<Solution> solutions(m, Solution(instance));
+    threads.clear();
+    for (Counter node_id = 0; node_id <= root; ++node_id) {
+        const BellmanparArrayNode& node = nodes[node_id];
+        if (node.left != -1)
+            continue;
+        threads.push_back(std::thread(bellman_array_rec_solve, std::ref(instance),
+                    bounds[node.n1], bounds[node.n2], capacities[node_id],
+                    std::ref(solutions[node.n1]), std::ref(info)));
+    }
+    for (std::thread& thread: threads)
+        thread.join();
+    if (!info.check_time())
+        return output.algorithm_end(info);
+    Solution sol(instance);
+    for (Counter i = 0; i < m; ++i)
+        for (ItemPos j = bounds[i]; j < bounds[i + 1]; ++j)
+            if (solutions[i].contains(j))
+                sol.set(j, true);
+    output.update_sol(sol, std::stringstream(), info);
+
+    return output.algorithm_end(info);
+}
+
+/************************** bellmanpar_array_capacity *************************/
+
+struct BellmanparArrayCapacityData
+{
+    const Instance& instance;
+    std::vector<Profit>& values_1;
+    std::vector<Profit>& values_2;
+    Barrier& barrier;
+    bool& end;
+};
+
+void bellmanpar_array_capacity_worker(
+        BellmanparArrayCapacityData d, Weight w_first, Weight w_last)
+{
+    for (ItemPos j = 0; j < d.instance.item_number() && !d.end; ++j) {
+        // Item j reads values_1 and writes values_2 if j is even, and the
+        // opposite otherwise.
+        const std::vector<Profit>& values_src = (j % 2 == 0)? d.values_1: d.values_2;
+        std::vector<Profit>& values_dst = (j % 2 == 0)? d.values_2: d.values_1;
+        Weight wj = d.instance.item(j).w;
+        Profit pj = d.instance.item(j).p;
+        Weight w = std::max(w_first, std::min(wj, w_last + 1));
+        std::copy(
+                values_src.begin() + w_first,
+                values_src.begin() + w,
+                values_dst.begin() + w_first);
+        if (w <= w_last)
+            bellman_array_update(
+                    values_src.data() + w,
+                    values_src.data() + w - wj,
+                    values_dst.data() + w,
+                    w_last - w + 1, pj);
+        d.barrier.arrive_and_wait();
+    }
+}
+
+Output knapsacksolver::bellmanpar_array_capacity(
+        const Instance& instance, Counter thread_number, Info info)
+{
+    VER(info, "*** bellmanpar (array, capacity, " << thread_number << " threads) ***" << std::endl);
+    Output output(instance, info);
+    ItemIdx n = instance.item_number();
+    Weight c = instance.capacity();
+    if (thread_number < 1)
+        thread_number = 1;
+
+    // Each item is processed by all threads, each one on its own range of
+    // capacities. Since values[w - wj] may belong to the range of another
+    // thread, the values of item j are written in a second array. The
+    // threads are synchronized after each item.
+    std::vector<Profit> values_1(c + 1, 0);
+    std::vector<Profit> values_2(c + 1, 0);
+    ItemPos j = 0;
+    bool end = false;
+    Barrier barrier(thread_number, [&]()
+            {
+                // Update lower bound
+                const std::vector<Profit>& values = (j % 2 == 0)? values_2: values_1;
+                if (output.lower_bound < values[c]) {
+                    std::stringstream ss;
+                    ss << "it " << j;
+                    output.update_lb(values[c], ss, info);
+                }
+                j++;
+
+                // Check time
+                if (j < n && !info.check_time())
+                    end = true;
+            });
+    BellmanparArrayCapacityData d {
+        .instance = instance,
+        .values_1 = values_1,
+        .values_2 = values_2,
+        .barrier  = barrier,
+        .end      = end};
+
+    Weight block_size = (c + thread_number) / thread_number;
+    std::vector<std::thread> threads;
+    for (Counter thread_id = 1; thread_id < thread_number; ++thread_id)
+        threads.push_back(std::thread(bellmanpar_array_capacity_worker, d,
+                    thread_id * block_size,
+                    std::min(c, (thread_id + 1) * block_size - 1)));
+    bellmanpar_array_capacity_worker(d, 0, std::min(c, block_size - 1));
+    for (std::thread& thread: threads)
+        thread.join();
+    if (end)
+        return output.algorithm_end(info);
+
+    // Update upper bound
+    const std::vector<Profit>& values = (n % 2 == 0)? values_1: values_2;
+    output.update_ub(values[c], std::stringstream("tree search completed"), info);
+
     return output.algorithm_end(info);
 }
 
@@ -159,40 +631,122 @@ Output knapsacksolver::bellmanrec(const Instance& instance, Info info)
 
 /***************************** bellman_array_all ******************************/
 
-Output knapsacksolver::bellman_array_all(const Instance& instance, Info info)
+template <typename T>
+Output bellman_array_all_typed(const Instance& instance, Info& info)
 {
-    VER(info, "*** bellman (array, all) ***" << std::endl);
     Output output(instance, info);
 
     // Initialize memory table
     ItemPos n = instance.item_number();
     Weight  c = instance.capacity();
     StateIdx values_size = (n + 1) * (c + 1);
-    std::vector<Profit> values(values_size);
+    std::vector<T> values(values_size);
 
     // Compute optimal value
+    // The rows are filled by blocks of items. Inside a block, the table is
+    // filled tile by tile, so that the cells of row j - 1 read to compute
+    // row j are still in cache.
+    ItemIdx block_size = bellman_array_block_size<T>(instance);
+    Weight tile_size = (block_size > 1)? BELLMAN_ARRAY_TILE_SIZE: c + 1;
     std::fill(values.begin(), values.begin() + c + 1, 0);
-    for (ItemPos j = 0; j < instance.item_number(); ++j) {
+    for (ItemPos j1 = 0; j1 < n; j1 += block_size) {
         // Check time
         if (!info.check_time())
             return output.algorithm_end(info);
 
         // Fill DP table
-        Weight wj = instance.item(j).w;
-        for (Weight w = 0; w < wj; ++w)
-            values[INDEX(j, w)] = values[INDEX(j-1, w)];
-        Profit pj = instance.item(j).p;
-        for (Weight w = wj; w <= c; ++w) {
-            Profit v0 = values[INDEX(j - 1 ,w)];
-            Profit v1 = values[INDEX(j - 1, w - wj)] + pj;
-            values[INDEX(j, w)] = std::max(v1, v0);
+        ItemPos j2 = std::min(n, j1 + block_size);
+        for (Weight a = 0; a <= c; a += tile_size) {
+            Weight e = std::min(c + 1, a + tile_size);
+            for (ItemPos j = j1; j < j2; ++j) {
+                Weight wj = std::min(instance.item(j).w, c + 1);
+                Weight b = std::min(std::max(wj, a), e);
+                std::copy(
+                        values.begin() + INDEX(j - 1, a),
+                        values.begin() + INDEX(j - 1, b),
+                        values.begin() + INDEX(j, a));
+                T pj = instance.item(j).p;
+                if (b < e)
+                    bellman_array_update(
+                            values.data() + INDEX(j - 1, b),
+                            values.data() + INDEX(j - 1, b - wj),
+                            values.data() + INDEX(j, b),
+                            e - b, pj);
+            }
         }
 
         // Update lower bound
-        if (output.lower_bound < values[INDEX(j, c)]) {
+        for (ItemPos j = j1; j < j2; ++j) {
+            if (output.lower_bound < values[INDEX(j, c)]) {
+                std::stringstream ss;
+                ss << "it " << j;
+                output.update_lb(values[INDEX(j, c)], ss, info);
+            }
+        }
+    }
+
+    // Update upper bound
+    output.update_ub(output.lower_bound, std::stringstream("tree search completed"), info);
+
+    // Retrieve optimal solution
+    Weight w = c;
+    Solution sol(instance);
+    for (ItemPos j = n - 1; j >= 0; --j) {
+        if (values[INDEX(j, w)] != values[INDEX(j - 1, w)]) {
+            w -= instance.item(j).w;
+            sol.set(j, true);
+        }
+    }
+    output.update_sol(sol, std::stringstream(), info);
+
+    return output.algorithm_end(info);
+}
+
+Output knapsacksolver::bellman_array_all(const Instance& instance, Info info)
+{
+    VER(info, "*** bellman (array, all) ***" << std::endl);
+    switch (dp_value_size(bellman_array_value_bound(instance))) {
+    case 2: return bellman_array_all_typed<int16_t>(instance, info);
+    case 4: return bellman_array_all_typed<int32_t>(instance, info);
+    default: return bellman_array_all_typed<int64_t>(instance, info);
+    }
+}
+
+/***************************** bellman_array_bits *****************************/
+
+template <typename T>
+Output bellman_array_bits_typed(const Instance& instance, Info& info)
+{
+    Output output(instance, info);
+
+    // Initialize memory table
+    // Bit w of row j of "taken" is set iff item j is taken in the optimal
+    // solution of the sub-instance made of items 0, ..., j and of capacity w.
+    ItemPos n = instance.item_number();
+    Weight  c = instance.capacity();
+    StateIdx word_number = c / 64 + 1;
+    std::vector<uint64_t> taken(n * word_number, 0);
+    std::vector<T> values(c + 1, 0);
+
+    // Compute optimal value
+    for (ItemPos j = 0; j < n; ++j) {
+        // Check time
+        if (!info.check_time())
+            return output.algorithm_end(info);
+
+        // Update DP table
+        Weight wj = instance.item(j).w;
+        T pj = instance.item(j).p;
+        if (wj <= c)
+            bellman_array_update_bits(
+                    &values[wj], &values[0], &values[wj], c - wj + 1, pj,
+                    taken.data() + j * word_number, wj);
+
+        // Update lower bound
+        if (output.lower_bound < values[c]) {
             std::stringstream ss;
             ss << "it " << j;
-            output.update_lb(values[INDEX(j, c)], ss, info);
+            output.update_lb(values[c], ss, info);
         }
     }
 
@@ -203,7 +757,7 @@ Output knapsacksolver::bellman_array_all(const Instance& instance, Info info)
     Weight w = c;
     Solution sol(instance);
     for (ItemPos j = n - 1; j >= 0; --j) {
-        if (values[INDEX(j, w)] != values[INDEX(j - 1, w)]) {
+        if ((taken[j * word_number + w / 64] >> (w % 64)) & 1) {
             w -= instance.item(j).w;
             sol.set(j, true);
         }
@@ -213,6 +767,354 @@ Output knapsacksolver::bellman_array_all(const Instance& instance, Info info)
     return output.algorithm_end(info);
 }
 
+Output knapsacksolver::bellman_array_bits(const Instance& instance, Info info)
+{
+    VER(info, "*** bellman (array, bits) ***" << std::endl);
+    switch (dp_value_size(bellman_array_value_bound(instance))) {
+    case 2: return bellman_array_bits_typed<int16_t>(instance, info);
+    case 4: return bellman_array_bits_typed<int32_t>(instance, info);
+    default: return bellman_array_bits_typed<int64_t>(instance, info);
+    }
+}
+
+/***************************** bellman_array_file *****************************/
+
+template <typename T>
+Output bellman_array_file_typed(const Instance& instance,
+        std::string scratch_directory, Info& info)
+{
+    Output output(instance, info);
+
+    // Initialize memory table
+    // Same decision bits as bellman_array_bits, but the rows are written to a
+    // scratch file, so that only the current row of values is kept in memory.
+    ItemPos n = instance.item_number();
+    Weight  c = instance.capacity();
+    StateIdx word_number = c / 64 + 1;
+    DpRowFile file(scratch_directory, word_number * sizeof(uint64_t), n);
+    if (!file.ok()) {
+        VER(info, "Cannot create the scratch file, the decision bits are kept in memory." << std::endl);
+        return bellman_array_bits_typed<T>(instance, info);
+    }
+    std::vector<uint64_t> taken(word_number);
+    std::vector<T> values(c + 1, 0);
+
+    // Compute optimal value
+    for (ItemPos j = 0; j < n; ++j) {
+        // Check time
+        if (!info.check_time())
+            return output.algorithm_end(info);
+
+        // Update DP table
+        Weight wj = instance.item(j).w;
+        T pj = instance.item(j).p;
+        std::fill(taken.begin(), taken.end(), 0);
+        if (wj <= c)
+            bellman_array_update_bits(
+                    &values[wj], &values[0], &values[wj], c - wj + 1, pj,
+                    taken.data(), wj);
+        file.append(taken.data());
+
+        // Update lower bound
+        if (output.lower_bound < values[c]) {
+            std::stringstream ss;
+            ss << "it " << j;
+            output.update_lb(values[c], ss, info);
+        }
+    }
+    file.finish();
+    if (!file.ok()) {
+        VER(info, "Cannot write the scratch file, the decision bits are kept in memory." << std::endl);
+        return bellman_array_bits_typed<T>(instance, info);
+    }
+
+    // Update upper bound
+    output.update_ub(output.lower_bound, std::stringstream("tree search completed"), info);
+
+    // Retrieve optimal solution
+    Weight w = c;
+    Solution sol(instance);
+    for (ItemPos j = n - 1; j >= 0; --j) {
+        // The word of row j - 1 which will be read is one of two words.
+        Weight wj = instance.item(j).w;
+        if (j > 0) {
+            file.prefetch(j - 1, w / 64 * sizeof(uint64_t), sizeof(uint64_t));
+            if (w >= wj)
+                file.prefetch(j - 1, (w - wj) / 64 * sizeof(uint64_t), sizeof(uint64_t));
+        }
+        const uint64_t* row = (const uint64_t*)file.row(j);
+        if ((row[w / 64] >> (w % 64)) & 1) {
+            w -= wj;
+            sol.set(j, true);
+        }
+    }
+    output.update_sol(sol, std::stringstream(), info);
+
+    return output.algorithm_end(info);
+}
+
+Output knapsacksolver::bellman_array_file(const Instance& instance,
+        std::string scratch_directory, Info info)
+{
+    VER(info, "*** bellman (array, file) ***" << std::endl);
+    switch (dp_value_size(bellman_array_value_bound(instance))) {
+    case 2: return bellman_array_file_typed<int16_t>(instance, scratch_directory, info);
+    case 4: return bellman_array_file_typed<int32_t>(instance, scratch_directory, info);
+    default: return bellman_array_file_typed<int64_t>(instance, scratch_directory, info);
+    }
+}
+
+/************************** bellman_array_checkpoint **************************/
+
+/**
+ * Fill rows[0..n2 - n1 - 1] with the rows of the DP table after items n1,
+ * ..., n2 - 1, starting from row "first".
+ */
+template <typename T>
+void bellman_array_checkpoint_block(const Instance& instance,
+        ItemPos n1, ItemPos n2, const T* first, T* rows)
+{
+    Weight c = instance.capacity();
+    const T* prev = first;
+    for (ItemPos j = n1; j < n2; ++j) {
+        T* cur = rows + (j - n1) * (c + 1);
+        Weight wj = std::min(instance.item(j).w, c + 1);
+        std::copy(prev, prev + wj, cur);
+        T pj = instance.item(j).p;
+        bellman_array_update(prev + wj, prev, cur + wj, c - wj + 1, pj);
+        prev = cur;
+    }
+}
+
+/**
+ * Return the number of items k of the blocks: the rows before each block and
+ * the k rows of the current block are stored.
+ *
+ * The largest k such that (ceil(n / k) + k) * (c + 1) values fit in the
+ * memory limit is chosen, since the rows of the last block don't need to be
+ * recomputed. If no k fits, the one minimizing the memory is returned.
+ */
+template <typename T>
+ItemIdx bellman_array_checkpoint_block_size(ItemIdx n, Weight c, StateIdx memory_limit)
+{
+    ItemIdx k_min = std::max((ItemIdx)1, (ItemIdx)std::ceil(std::sqrt((double)n)));
+    StateIdx row_size = (c + 1) * sizeof(T);
+    ItemIdx k = k_min;
+    for (ItemIdx k_next = 2 * k; k_next <= 2 * n; k_next *= 2) {
+        ItemIdx kk = std::min(k_next, n);
+        if (((n + kk - 1) / kk + kk) * row_size > memory_limit)
+            break;
+        k = kk;
+    }
+    return k;
+}
+
+template <typename T>
+Output bellman_array_checkpoint_typed(const Instance& instance, StateIdx memory_limit, Info& info)
+{
+    Output output(instance, info);
+
+    ItemPos n = instance.item_number();
+    Weight  c = instance.capacity();
+    if (n == 0) {
+        output.update_ub(0, std::stringstream("no item"), info);
+        return output.algorithm_end(info);
+    }
+
+    // Initialize memory table
+    // checkpoints[b] is the row before the items of block b; rows contains
+    // the rows of the current block.
+    ItemIdx k = bellman_array_checkpoint_block_size<T>(n, c, memory_limit);
+    ItemIdx block_number = (n + k - 1) / k;
+    VER(info, "Block size: " << k << std::endl);
+    PUT(info, "Algorithm", "BlockSize", k);
+    std::vector<T> checkpoints(block_number * (c + 1), 0);
+    std::vector<T> rows(k * (c + 1));
+
+    // Compute optimal value
+    for (ItemIdx b = 0; b < block_number; ++b) {
+        // Check time
+        if (!info.check_time())
+            return output.algorithm_end(info);
+
+        ItemPos n1 = b * k;
+        ItemPos n2 = std::min(n, n1 + k);
+        bellman_array_checkpoint_block(instance, n1, n2,
+                checkpoints.data() + b * (c + 1), rows.data());
+        T* last = rows.data() + (n2 - n1 - 1) * (c + 1);
+        if (b + 1 < block_number)
+            std::copy(last, last + c + 1, checkpoints.begin() + (b + 1) * (c + 1));
+
+        // Update lower bound
+        if (output.lower_bound < last[c]) {
+            std::stringstream ss;
+            ss << "it " << n2 - 1;
+            output.update_lb(last[c], ss, info);
+        }
+    }
+
+    // Update upper bound
+    output.update_ub(output.lower_bound, std::stringstream("tree search completed"), info);
+
+    // Retrieve optimal solution
+    // The rows of the last block are still in memory, the ones of the other
+    // blocks are recomputed from their checkpoint.
+    Weight w = c;
+    Solution sol(instance);
+    for (ItemIdx b = block_number - 1; b >= 0; --b) {
+        ItemPos n1 = b * k;
+        ItemPos n2 = std::min(n, n1 + k);
+        const T* first = checkpoints.data() + b * (c + 1);
+        if (b != block_number - 1) {
+            if (!info.check_time())
+                return output.algorithm_end(info);
+            bellman_array_checkpoint_block(instance, n1, n2, first, rows.data());
+        }
+        for (ItemPos j = n2 - 1; j >= n1; --j) {
+            const T* cur = rows.data() + (j - n1) * (c + 1);
+            const T* prev = (j == n1)? first: cur - (c + 1);
+            if (cur[w] != prev[w]) {
+                w -= instance.item(j).w;
+                sol.set(j, true);
+            }
+        }
+    }
+    output.update_sol(sol, std::stringstream(), info);
+
+    return output.algorithm_end(info);
+}
+
+Output knapsacksolver::bellman_array_checkpoint(const Instance& instance,
+        StateIdx memory_limit, Info info)
+{
+    VER(info, "*** bellman (array, checkpoint) ***" << std::endl);
+    switch (dp_value_size(bellman_array_value_bound(instance))) {
+    case 2: return bellman_array_checkpoint_typed<int16_t>(instance, memory_limit, info);
+    case 4: return bellman_array_checkpoint_typed<int32_t>(instance, memory_limit, info);
+    default: return bellman_array_checkpoint_typed<int64_t>(instance, memory_limit, info);
+    }
+}
+
+/*************************** bellman_array_bounded ****************************/
+
+/**
+ * At item j, cell w of the table is only updated if it can still be part of
+ * an improving solution:
+ * - w >= c - (sum of the weights of items j + 1, ..., n - 1), otherwise the
+ *   remaining items can't fill the knapsack from w, so values[w] is never
+ *   read again to compute values[c] (Toth, 1980)
+ * - w <= sum of the weights of items 0, ..., j, otherwise values[w] is equal
+ *   to the value of this sum
+ * - w >= w_lo, where cells w < w_lo satisfy
+ *   values[w] + (c - w) * p(j + 1) / w(j + 1) <= lb, the items being sorted
+ *   by non-increasing efficiency. Since the efficiencies of the next items
+ *   only decrease, these cells can't lead to a better solution than lb, and
+ *   neither can the cells computed from them, therefore w_lo only increases.
+ * Cells which are not updated keep a feasible value.
+ */
+template <typename T>
+void bellman_array_bounded_typed(
+        const Instance& instance, Output& output, Info& info)
+{
+    Weight c = instance.reduced_capacity();
+    Profit p0 = (instance.reduced_solution() == NULL)? 0: instance.reduced_solution()->profit();
+    std::vector<T> values(c + 1, 0);
+
+    Weight w_after = 0;
+    Profit p_max = 0;
+    for (ItemPos j = instance.first_item(); j <= instance.last_item(); ++j) {
+        if (instance.item(j).w <= c) {
+            w_after += instance.item(j).w;
+            p_max = std::max(p_max, instance.item(j).p);
+        }
+    }
+    bool prune = (p_max == 0 || INT_FAST64_MAX / p_max >= c);
+
+    Weight w_prefix = 0;
+    Weight w_lo = 0;
+    for (ItemPos j = instance.first_item(); j <= instance.last_item(); ++j) {
+        // Check time
+        if (!info.check_time())
+            return;
+
+        Weight wj = instance.item(j).w;
+        T pj = instance.item(j).p;
+        if (wj > c)
+            continue;
+        w_after -= wj;
+
+        // Update DP table
+        Weight w_hi = std::min(c, w_prefix + wj);
+        std::fill(values.begin() + w_prefix + 1, values.begin() + w_hi + 1, values[w_prefix]);
+        Weight w_first = std::max(std::max(wj, c - w_after), w_lo);
+        if (w_first <= w_hi)
+            bellman_array_update(&values[w_first], &values[w_first - wj], &values[w_first],
+                    w_hi - w_first + 1, pj);
+        w_prefix = w_hi;
+
+        // Update lower bound
+        if (output.lower_bound < p0 + values[w_prefix]) {
+            std::stringstream ss;
+            ss << "it " << j - instance.first_item();
+            output.update_lb(p0 + values[w_prefix], ss, info);
+        }
+
+        // Update window
+        if (prune && j + 1 <= instance.last_item()) {
+            Profit bp = instance.item(j + 1).p;
+            Weight bw = instance.item(j + 1).w;
+            while (w_lo <= w_prefix
+                    && p0 + values[w_lo] + (c - w_lo) * bp / bw <= output.lower_bound)
+                w_lo++;
+        }
+    }
+
+    // Update upper bound
+    output.update_ub(output.lower_bound, std::stringstream("tree search completed"), info);
+}
+
+Output knapsacksolver::bellman_array_bounded(Instance& instance, Info info)
+{
+    VER(info, "*** bellman (array, bounded) ***" << std::endl);
+    Output output(instance, info);
+
+    if (instance.item_number() == 0 || instance.capacity() == 0) {
+        output.update_ub(0, std::stringstream("no item or null capacity"), info);
+        return output.algorithm_end(info);
+    }
+
+    instance.sort(info);
+    if (instance.break_item() == instance.last_item() + 1) {
+        output.update_lb(instance.break_solution()->profit(), std::stringstream("all items fit in the knapsack (lb)"), info);
+        output.update_ub(output.lower_bound, std::stringstream("all item fit in the knapsack (ub)"), info);
+        return output.algorithm_end(info);
+    }
+    auto g_output = greedynlogn(instance);
+    output.update_sol(g_output.solution, std::stringstream("greedynlogn"), info);
+
+    instance.reduce2(output.lower_bound, info);
+    if (instance.reduced_capacity() < 0) {
+        output.update_ub(output.lower_bound, std::stringstream("negative capacity after reduction"), info);
+        return output.algorithm_end(info);
+    } else if (instance.reduced_item_number() == 0 || instance.reduced_capacity() == 0) {
+        output.update_sol(*instance.reduced_solution(), std::stringstream("no item or null capacity after reduction (lb)"), info);
+        output.update_ub(output.lower_bound, std::stringstream("no item or null capacity after reduction (ub)"), info);
+        return output.algorithm_end(info);
+    } else if (instance.break_item() == instance.last_item() + 1) {
+        output.update_sol(*instance.break_solution(), std::stringstream("all items fit in the knapsack after reduction (lb)"), info);
+        output.update_ub(output.lower_bound, std::stringstream("all items fit in the knapsack after reduction (ub)"), info);
+        return output.algorithm_end(info);
+    }
+    output.update_ub(std::max(ub_dantzig(instance), output.lower_bound), std::stringstream("initial upper bound"), info);
+
+    switch (dp_value_size(bellman_array_value_bound(instance))) {
+    case 2: bellman_array_bounded_typed<int16_t>(instance, output, info); break;
+    case 4: bellman_array_bounded_typed<int32_t>(instance, output, info); break;
+    default: bellman_array_bounded_typed<int64_t>(instance, output, info); break;
+    }
+    return output.algorithm_end(info);
+}
+
 /***************************** bellman_array_one ******************************/
 
 Output knapsacksolver::bellman_array_one(const Instance& instance, Info info)
@@ -309,12 +1211,11 @@ end:
 
 /**************************** bellman_array_part ******************************/
 
-Output knapsacksolver::bellman_array_part(const Instance& instance, ItemPos k, Info info)
+template <typename PartSol>
+Output bellman_array_part_typed(const Instance& instance, ItemPos k, Info info)
 {
-    VER(info, "*** bellman (array, part " << k << ") ***" << std::endl);
     Output output(instance, info);
 
-    assert(0 <= k && k <= 64);
     ItemPos n = instance.item_number();
     Weight  c = instance.capacity();
     Solution sol(instance);
@@ -325,7 +1226,7 @@ Output knapsacksolver::bellman_array_part(const Instance& instance, ItemPos k, I
     }
 
     std::vector<Profit> values(c + 1); // Initialize memory table
-    std::vector<PartSol1> bisols(c + 1);
+    std::vector<PartSol> bisols(c + 1);
     ItemPos it = 0;
     Profit opt = -1;
     Profit opt_local = -1;
@@ -333,12 +1234,12 @@ Output knapsacksolver::bellman_array_part(const Instance& instance, ItemPos k, I
         it++;
         LOG(info, "it " << it << " n " << n << " opt_local " << opt_local << std::endl);
 
-        PartSolFactory1 psolf(instance, k, n - 1, 0, n - 1);
+        PartSolFactory1<PartSol> psolf(instance, k, n - 1, 0, n - 1);
         Weight w_opt = c;
 
         // Initialization
         std::fill(values.begin(), values.end(), 0);
-        std::fill(bisols.begin(), bisols.end(), 0);
+        std::fill(bisols.begin(), bisols.end(), PartSol());
 
         // Recursion
         for (ItemPos j = 0; j < n; ++j) {
@@ -396,6 +1297,20 @@ end:
     return output;
 }
 
+Output knapsacksolver::bellman_array_part(const Instance& instance, ItemPos k, Info info)
+{
+    VER(info, "*** bellman (array, part " << k << ") ***" << std::endl);
+    assert(0 <= k && k <= PARTSOL_SIZE_MAX);
+    switch (partsol_word_size(k)) {
+    case 64: return bellman_array_part_typed<uint64_t>(instance, k, info);
+#if defined(KNAPSACKSOLVER_PARTSOL_INT128)
+    case 128: return bellman_array_part_typed<unsigned __int128>(instance, k, info);
+#endif
+    case 256: return bellman_array_part_typed<std::bitset<256>>(instance, k, info);
+    default: return bellman_array_part_typed<std::bitset<512>>(instance, k, info);
+    }
+}
+
 /***************************** bellman_array_rec ******************************/
 
 struct RecData
@@ -407,6 +1322,14 @@ struct RecData
     Solution& sol;
     std::vector<Profit>::iterator values;
     Info& info;
+    /** For the parallel version, NULL otherwise. */
+    ThreadBudget* budget;
+    /**
+     * Sub-problems of size (n2 - n1) * (c + 1) smaller than this are not
+     * split between threads.
+     */
+    StateIdx parallel_size_min;
+    std::mutex* sol_mutex;
 };
 
 void opts_bellman_array(const Instance& instance, ItemPos n1, ItemPos n2, Weight c,
@@ -418,9 +1341,18 @@ void opts_bellman_array(const Instance& instance, ItemPos n1, ItemPos n2, Weight
             break;
         Weight wj = instance.item(j).w;
         Profit pj = instance.item(j).p;
-        for (Weight w = c; w >= wj; w--)
-            if (*(values + w) < *(values + w - wj) + pj)
-                *(values + w) = *(values + w - wj) + pj;
+        if (wj <= c)
+            bellman_array_update(&values[wj], &values[0], &values[wj], c - wj + 1, pj);
+    }
+}
+
+void bellman_array_rec_set(RecData& d, ItemPos j)
+{
+    if (d.sol_mutex == NULL) {
+        d.sol.set(j, true);
+    } else {
+        std::lock_guard<std::mutex> lock(*d.sol_mutex);
+        d.sol.set(j, true);
     }
 }
 
@@ -430,8 +1362,14 @@ void bellman_array_rec_rec(RecData d)
     std::vector<Profit>::iterator values_2 = d.values + d.c + 1;
     LOG(d.info, "n1 " << d.n1 << " k " << k << " n2 " << d.n2 << " c " << d.c << std::endl);
 
-    opts_bellman_array(d.instance, d.n1, k, d.c, d.values, d.info);
-    opts_bellman_array(d.instance, k, d.n2, d.c, values_2, d.info);
+    // The two forward passes and the two sub-problems use disjoint parts of
+    // d.values, therefore, they can be run in parallel.
+    ThreadBudget* budget = ((d.n2 - d.n1) * (d.c + 1) >= d.parallel_size_min)?
+        d.budget: NULL;
+
+    fork_join(budget,
+            [&d, k]() { opts_bellman_array(d.instance, d.n1, k, d.c, d.values, d.info); },
+            [&d, k, values_2]() { opts_bellman_array(d.instance, k, d.n2, d.c, values_2, d.info); });
 
     Profit z_max  = -1;
     Weight c1_opt = 0;
@@ -450,34 +1388,74 @@ void bellman_array_rec_rec(RecData d)
 
     if (d.n1 == k - 1)
         if (*(d.values + c1_opt) == d.instance.item(d.n1).p)
-            d.sol.set(d.n1, true);
+            bellman_array_rec_set(d, d.n1);
     if (k == d.n2 - 1)
         if (*(values_2 + c2_opt) == d.instance.item(k).p)
-            d.sol.set(k, true);
-
-    if (d.n1 != k - 1)
-        bellman_array_rec_rec({
-                .instance = d.instance,
-                .n1 = d.n1,
-                .n2 = k,
-                .c = c1_opt,
-                .sol = d.sol,
-                .values = d.values,
-                .info = d.info});
-    if (k != d.n2 - 1)
-        bellman_array_rec_rec({
-                .instance = d.instance,
-                .n1 = k,
-                .n2 = d.n2,
-                .c = c2_opt,
-                .sol = d.sol,
-                .values = d.values + 2 * c1_opt + k - d.n1,
-                .info = d.info});
+            bellman_array_rec_set(d, k);
+
+    fork_join(budget,
+            [&d, k, c1_opt]()
+            {
+                if (d.n1 != k - 1)
+                    bellman_array_rec_rec({
+                            .instance = d.instance,
+                            .n1 = d.n1,
+                            .n2 = k,
+                            .c = c1_opt,
+                            .sol = d.sol,
+                            .values = d.values,
+                            .info = d.info,
+                            .budget = d.budget,
+                            .parallel_size_min = d.parallel_size_min,
+                            .sol_mutex = d.sol_mutex});
+            },
+            [&d, k, c1_opt, c2_opt]()
+            {
+                if (k != d.n2 - 1)
+                    bellman_array_rec_rec({
+                            .instance = d.instance,
+                            .n1 = k,
+                            .n2 = d.n2,
+                            .c = c2_opt,
+                            .sol = d.sol,
+                            .values = d.values + 2 * c1_opt + k - d.n1,
+                            .info = d.info,
+                            .budget = d.budget,
+                            .parallel_size_min = d.parallel_size_min,
+                            .sol_mutex = d.sol_mutex});
+            });
 }
 
-Output knapsacksolver::bellman_array_rec(const Instance& instance, Info info)
+/**
+ * Add to sol an optimal solution of the sub-instance made of items n1, ...,
+ * n2 - 1 and of capacity c.
+ */
+void bellman_array_rec_solve(const Instance& instance,
+        ItemPos n1, ItemPos n2, Weight c, Solution& sol, Info& info)
+{
+    if (n2 - n1 == 1) {
+        if (instance.item(n1).w <= c)
+            sol.set(n1, true);
+        return;
+    }
+    std::vector<Profit> values(2 * c + n2 - n1);
+    bellman_array_rec_rec({
+        .instance = instance,
+        .n1 = n1,
+        .n2 = n2,
+        .c = c,
+        .sol = sol,
+        .values = values.begin(),
+        .info = info,
+        .budget = NULL,
+        .parallel_size_min = 0,
+        .sol_mutex = NULL,
+    });
+}
+
+Output bellman_array_rec_main(const Instance& instance,
+        ThreadBudget* budget, StateIdx parallel_size_min, Info& info)
 {
-    VER(info, "*** bellman (array, rec) ***" << std::endl);
     Output output(instance, info);
 
     if (instance.item_number() == 0) {
@@ -493,6 +1471,7 @@ Output knapsacksolver::bellman_array_rec(const Instance& instance, Info info)
 
     std::vector<Profit> values(2 * instance.capacity() + instance.item_number());
     Solution sol(instance);
+    std::mutex sol_mutex;
     bellman_array_rec_rec({
         .instance = instance,
         .n1 = 0,
@@ -500,7 +1479,10 @@ Output knapsacksolver::bellman_array_rec(const Instance& instance, Info info)
         .c = instance.capacity(),
         .sol = sol,
         .values = values.begin(),
-        .info = info
+        .info = info,
+        .budget = budget,
+        .parallel_size_min = parallel_size_min,
+        .sol_mutex = (budget != NULL)? &sol_mutex: NULL,
     });
     if (!info.check_time())
         return output.algorithm_end(info);
@@ -510,24 +1492,104 @@ Output knapsacksolver::bellman_array_rec(const Instance& instance, Info info)
     return output.algorithm_end(info);
 }
 
+Output knapsacksolver::bellman_array_rec(const Instance& instance, Info info)
+{
+    VER(info, "*** bellman (array, rec) ***" << std::endl);
+    return bellman_array_rec_main(instance, NULL, 0, info);
+}
+
+/**************************** bellmanpar_array_rec *****************************/
+
+Output knapsacksolver::bellmanpar_array_rec(const Instance& instance,
+        Counter thread_number, StateIdx parallel_size_min, Info info)
+{
+    VER(info, "*** bellmanpar (array, rec) ***" << std::endl);
+    ThreadBudget budget(thread_number);
+    return bellman_array_rec_main(instance, &budget, parallel_size_min, info);
+}
+
 /******************************** bellman_list ********************************/
 
-struct BellmanState
+/**
+ * List of states sorted by strictly increasing weights and profits, stored as
+ * a structure of arrays.
+ *
+ * State i is stored at index i + 1. Index 0 contains a sentinel (-1, -1) and
+ * index size + 1 a sentinel of weight BELLMAN_LIST_INF.
+ */
+struct BellmanStateList
 {
-    Weight w;
-    Profit p;
+    std::vector<Weight> w;
+    std::vector<Profit> p;
+    StateIdx size = 0;
 };
 
-std::ostream& operator<<(std::ostream& os, const BellmanState& s)
+const Weight BELLMAN_LIST_INF = std::numeric_limits<Weight>::max() / 4;
+
+void bellman_list_init(BellmanStateList& l, Weight w, Profit p)
 {
-    os << "(" << s.w <<  "," << s.p << ")";
-    return os;
+    l.w = {-1, w, BELLMAN_LIST_INF};
+    l.p = {-1, p, -1};
+    l.size = 1;
 }
 
-std::ostream& operator<<(std::ostream& os, const std::vector<BellmanState>& l)
+/**
+ * Merge the states of l0 and the states of l0 with item (wj, pj) added which
+ * fit in capacity c into l.
+ *
+ * Dominated states are removed, as well as states (w, p) such that
+ * p + floor((c - w) * bp / bw) <= lb. Use bp = 0 and bw = 1 to only remove
+ * the states of profit at most lb.
+ *
+ * The loop is branchless: at each step, the next state is always written at
+ * the end of l, and the size of l is only increased if it is kept. The bound
+ * test is done without division.
+ */
+void bellman_list_merge(const BellmanStateList& l0, BellmanStateList& l,
+        Weight wj, Profit pj, Weight c, Profit lb, Profit bp, Weight bw)
 {
-    std::copy(l.begin(), l.end(), std::ostream_iterator<BellmanState>(os, " "));
-    return os;
+    const Weight* aw = l0.w.data();
+    const Profit* ap = l0.p.data();
+    StateIdx na = l0.size;
+    // Number of states which still fit in the knapsack once item j is added.
+    StateIdx nb = (wj > c)? 0:
+        std::upper_bound(aw + 1, aw + 1 + na, c - wj) - (aw + 1);
+    if ((StateIdx)l.w.size() < na + nb + 2) {
+        l.w.resize(na + nb + 2);
+        l.p.resize(na + nb + 2);
+    }
+    Weight* ow = l.w.data();
+    Profit* op = l.p.data();
+    ow[0] = -1;
+    op[0] = -1;
+
+    // ub > lb <=> (c - w) * bp >= (lb - p + 1) * bw
+    Profit d_max = std::numeric_limits<Profit>::max() / bw;
+    StateIdx k = 1;
+    StateIdx ia = 1;
+    StateIdx ib = 1;
+    for (StateIdx t = 0; t < na + nb; ++t) {
+        Weight wa = aw[ia];
+        Profit pa = ap[ia];
+        Weight wb = aw[ib] + wj;
+        Profit pb = ap[ib] + pj;
+        bool take_b = (wb < wa);
+        Weight w = (take_b)? wb: wa;
+        Profit p = (take_b)? pb: pa;
+        ia += !take_b;
+        ib += take_b;
+
+        Profit d = lb - p + 1;
+        bool bound = (d <= 0) | ((d <= d_max) & ((c - w) * bp >= std::min(d, d_max) * bw));
+        bool keep = (p > op[k - 1]) & bound;
+        StateIdx pos = k - (keep & (w == ow[k - 1]));
+        ow[pos] = w;
+        op[pos] = p;
+        k = pos + keep;
+    }
+    ow[k] = BELLMAN_LIST_INF;
+    op[k] = -1;
+    l.size = k - 1;
 }
 
 Output knapsacksolver::bellman_list(Instance& instance, bool sort, Info info)
@@ -583,71 +1645,42 @@ Output knapsacksolver::bellman_list(Instance& instance, bool sort, Info info)
     Profit ub = (!sort)? ub_0(instance, 0, 0, instance.capacity(), j_max):
         std::max(ub_dantzig(instance), output.lower_bound);
     output.update_ub(ub, std::stringstream("initial upper bound"), info);
-    std::vector<BellmanState> l0{{
-        .w = (instance.reduced_solution() == NULL)? 0: instance.reduced_solution()->weight(),
-        .p = (instance.reduced_solution() == NULL)? 0: instance.reduced_solution()->profit()}};
-    for (ItemPos j = instance.first_item(); j <= instance.last_item() && !l0.empty(); ++j) {
+    BellmanStateList l0;
+    BellmanStateList l;
+    bellman_list_init(l0,
+            (instance.reduced_solution() == NULL)? 0: instance.reduced_solution()->weight(),
+            (instance.reduced_solution() == NULL)? 0: instance.reduced_solution()->profit());
+    for (ItemPos j = instance.first_item(); j <= instance.last_item() && l0.size > 0; ++j) {
         // Check time
         if (!info.check_time()) {
             LOG_FOLD_END(info, "no time left");
             return output.algorithm_end(info);
         }
 
-        Profit ub_max = -1;
-        Weight wj = instance.item(j).w;
-        Profit pj = instance.item(j).p;
-        std::vector<BellmanState> l;
-        std::vector<BellmanState>::iterator it  = l0.begin();
-        std::vector<BellmanState>::iterator it1 = l0.begin();
-        while (it != l0.end() || it1 != l0.end()) {
-            if (it1 != l0.end() && (it == l0.end() || it->w > it1->w + wj)) {
-                BellmanState s1{.w = it1->w + wj, .p = it1->p + pj};
-                if (s1.w > c)
-                    break;
-
-                Profit ub_curr = (!sort)?
-                    ub_0(instance, j+1, s1.p, c - s1.w, j_max):
-                    ub_dembo(instance, j+1, s1.p, c - s1.w);
-
-                if (ub_curr > output.lower_bound && (l.empty() || s1.p > l.back().p)) {
-                    // Update lower bound
-                    if (output.lower_bound < s1.p) {
-                        std::stringstream ss;
-                        ss << "it " << j - instance.first_item();
-                        output.update_lb(s1.p, ss, info);
-                    }
+        // Upper bound of a state (w, p): p + (c - w) * bp / bw
+        Profit bp = 0;
+        Weight bw = 1;
+        if (j + 1 <= instance.last_item()) {
+            ItemPos k = (!sort)? j_max: j + 1;
+            bp = instance.item(k).p;
+            bw = instance.item(k).w;
+        }
 
-                    if (ub_max < ub_curr)
-                        ub_max = ub_curr;
-                    if (!l.empty() && s1.w == l.back().w) {
-                        l.back() = s1;
-                    } else {
-                        l.push_back(s1);
-                    }
-                }
-                it1++;
-            } else {
-                assert(it != l0.end());
-
-                Profit ub_curr = (!sort)?
-                    ub_0(instance, j+1, it->p, c - it->w, j_max):
-                    ub_dembo(instance, j+1, it->p, c - it->w);
-
-                if (ub_curr > output.lower_bound && (l.empty() || it->p > l.back().p)) {
-                    if (ub_max < ub_curr)
-                        ub_max = ub_curr;
-                    if (!l.empty() && it->w == l.back().w) {
-                        l.back() = *it;
-                    } else {
-                        l.push_back(*it);
-                    }
-                }
-                ++it;
-            }
+        bellman_list_merge(l0, l, instance.item(j).w, instance.item(j).p, c,
+                output.lower_bound, bp, bw);
+        std::swap(l0, l);
+
+        // Update lower bound
+        if (l0.size > 0 && output.lower_bound < l0.p[l0.size]) {
+            std::stringstream ss;
+            ss << "it " << j - instance.first_item();
+            output.update_lb(l0.p[l0.size], ss, info);
         }
-        l0 = std::move(l);
 
         // Update upper bound
+        Profit ub_max = -1;
+        for (StateIdx i = 1; i <= l0.size; ++i)
+            ub_max = std::max(ub_max, l0.p[i] + (c - l0.w[i]) * bp / bw);
         if (ub_max != -1 && output.upper_bound > ub_max) {
             std::stringstream ss;
             ss << "it " << j - instance.first_item();
@@ -671,154 +1704,178 @@ struct BellmanListRecData
     Solution& sol;
     ItemPos j_max;
     Info& info;
+    /** For the parallel version, NULL otherwise. */
+    ThreadBudget* budget;
+    /**
+     * Sub-problems whose lists are expected to be smaller than this are not
+     * split between threads.
+     */
+    StateIdx parallel_size_min;
+    std::mutex* sol_mutex;
 };
 
-std::vector<BellmanState> opts_bellman_list(const Instance& instance,
-        ItemPos n1, ItemPos n2, Weight c, ItemPos j_max, Info& info)
+void opts_bellman_list(const Instance& instance,
+        ItemPos n1, ItemPos n2, Weight c, ItemPos j_max,
+        BellmanStateList& l0, BellmanStateList& l, Info& info)
 {
     LOG_FOLD_START(info, "solve n1 " << n1 << " n2 " << n2 << " c " << c << std::endl);
+    bellman_list_init(l0, 0, 0);
     if (c == 0) {
         LOG_FOLD_END(info, "c == 0");
-        return {{0, 0}};
+        return;
     }
 
     Profit lb = 0;
-    std::vector<BellmanState> l0{{0, 0}};
     for (ItemPos j = n1; j < n2; ++j) {
         if (!info.check_time())
             break;
         Weight wj = instance.item(j).w;
         Profit pj = instance.item(j).p;
         LOG(info, "j " << j << " wj " << wj << " pj " << pj << std::endl);
-        std::vector<BellmanState> l;
-        std::vector<BellmanState>::iterator it = l0.begin();
-        std::vector<BellmanState>::iterator it1 = l0.begin();
-        while (it != l0.end() || it1 != l0.end()) {
-            if (it1 != l0.end() && (it == l0.end() || it->w > it1->w + wj)) {
-                BellmanState s1{it1->w+wj, it1->p+pj};
-                LOG(info, "s1 " << s1);
-                if (s1.w > c) {
-                    LOG(info, " too large" << std::endl);
-                    break;
-                }
-                if (s1.p > l.back().p) {
-                    if (s1.p > lb) // Update lower bound
-                        lb = s1.p;
-                    if (s1.w == l.back().w) {
-                        LOG(info, " replace" << std::endl);
-                        l.back() = s1;
-                    } else {
-                        Profit ub = ub_0(instance, j, s1.p, c - s1.w, j_max);
-                        LOG(info, " ub " << ub << " lb " << lb);
-                        if (ub >= lb) {
-                            l.push_back(s1);
-                            LOG(info, " added" << std::endl);
-                        } else {
-                            LOG(info, " ×" << std::endl);
-                        }
-                    }
-                } else {
-                    LOG(info, " ×" << std::endl);
-                }
-                it1++;
-            } else {
-                LOG(info, "s0 " << *it);
-                if (l.empty()) {
-                    LOG(info, " added" << std::endl);
-                    l.push_back(*it);
-                } else {
-                    if (it->p > l.back().p) {
-                        if (it->w == l.back().w) {
-                            LOG(info, " replace" << std::endl);
-                            l.back() = *it;
-                        } else {
-                            LOG(info, " added" << std::endl);
-                            l.push_back(*it);
-                        }
-                    } else {
-                        LOG(info, " ×" << std::endl);
-                    }
-                }
-                ++it;
-            }
-        }
-        l0 = std::move(l);
+        // States such that ub_0(j, p, c - w) < lb are removed.
+        bellman_list_merge(l0, l, wj, pj, c, lb - 1,
+                instance.item(j_max).p, instance.item(j_max).w);
+        std::swap(l0, l);
+        lb = std::max(lb, l0.p[l0.size]);
     }
     LOG_FOLD_END(info, "");
-    return l0;
 }
 
-void bellman_list_rec_rec(BellmanListRecData d)
+struct BellmanListJoin
 {
-    ItemPos k = (d.n1 + d.n2 - 1) / 2 + 1;
-    LOG_FOLD_START(d.info, "rec n1 " << d.n1 << " n2 " << d.n2 << " k " << k << " c " << d.c << std::endl);
+    Profit z;
+    StateIdx i1;
+    StateIdx i2;
+};
 
-    std::vector<BellmanState> l1 = opts_bellman_list(d.instance, d.n1, k, d.c, d.j_max, d.info);
-    std::vector<BellmanState> l2 = opts_bellman_list(d.instance, k, d.n2, d.c, d.j_max, d.info);
-    LOG(d.info, "l1.size() " << l1.size() << " l2.size() " << l2.size() << std::endl);
+/**
+ * Return the best pair of a state i1 of l1, i1_first <= i1 < i1_last, and of
+ * a state i2 of l2 fitting together in capacity c.
+ *
+ * For a given i1, the best i2 is the last one which fits, therefore i2
+ * decreases when i1 increases. When threads are available and the range of
+ * i1 contains at least 2 * parallel_size_min states, it is split in two, and
+ * each part starts with a binary search of its first i2.
+ */
+BellmanListJoin bellman_list_rec_join(
+        const BellmanStateList& l1, const BellmanStateList& l2, Weight c,
+        StateIdx i1_first, StateIdx i1_last,
+        ThreadBudget* budget, StateIdx parallel_size_min)
+{
+    if (budget != NULL && i1_last - i1_first >= std::max((StateIdx)2, 2 * parallel_size_min)) {
+        StateIdx i1_mid = (i1_first + i1_last) / 2;
+        BellmanListJoin r1;
+        BellmanListJoin r2;
+        fork_join(budget,
+                [&]() { r1 = bellman_list_rec_join(l1, l2, c, i1_first, i1_mid, budget, parallel_size_min); },
+                [&]() { r2 = bellman_list_rec_join(l1, l2, c, i1_mid, i1_last, budget, parallel_size_min); });
+        return (r1.z >= r2.z)? r1: r2;
+    }
 
-    Profit z_max  = -1;
-    Weight i1_opt = 0;
-    Weight i2_opt = 0;
-    StateIdx i2 = l2.size() - 1;
-    for (StateIdx i1 = 0; i1 < (StateIdx)l1.size(); ++i1) {
-        while (l1[i1].w + l2[i2].w > d.c)
+    // State i of l1 (resp. l2) is stored at index i + 1.
+    const Weight* w1 = l1.w.data() + 1;
+    const Profit* p1 = l1.p.data() + 1;
+    const Weight* w2 = l2.w.data() + 1;
+    const Profit* p2 = l2.p.data() + 1;
+    BellmanListJoin r {-1, 0, 0};
+    StateIdx i2 = std::upper_bound(w2, w2 + l2.size, c - w1[i1_first]) - w2 - 1;
+    for (StateIdx i1 = i1_first; i1 < i1_last; ++i1) {
+        while (w1[i1] + w2[i2] > c)
             i2--;
-        LOG(d.info, "i1 " << i1 << " l1[i1].w " << l1[i1].w << " i2 " << i2 << " l2[i2].w " << l2[i2].w << std::endl);
         assert(i2 >= 0);
-        Profit z = l1[i1].p + l2[i2].p;
-        if (z_max < z) {
-            z_max = z;
-            i1_opt = i1;
-            i2_opt = i2;
-        }
+        Profit z = p1[i1] + p2[i2];
+        if (r.z < z)
+            r = {z, i1, i2};
     }
-    StateIdx i1 = l1.size() - 1;
-    for (StateIdx i2 = 0; i2 < (StateIdx)l2.size(); ++i2) {
-        while (l2[i2].w + l1[i1].w > d.c)
-            i1--;
-        Profit z = l1[i1].p + l2[i2].p;
-        if (z_max < z) {
-            z_max = z;
-            i1_opt = i1;
-            i2_opt = i2;
-        }
+    return r;
+}
+
+void bellman_list_rec_set(BellmanListRecData& d, ItemPos j)
+{
+    if (d.sol_mutex == NULL) {
+        d.sol.set(j, true);
+    } else {
+        std::lock_guard<std::mutex> lock(*d.sol_mutex);
+        d.sol.set(j, true);
     }
-    LOG(d.info, "z_max " << z_max << std::endl );
+}
+
+void bellman_list_rec_rec(BellmanListRecData d)
+{
+    ItemPos k = (d.n1 + d.n2 - 1) / 2 + 1;
+    LOG_FOLD_START(d.info, "rec n1 " << d.n1 << " n2 " << d.n2 << " k " << k << " c " << d.c << std::endl);
+
+    // The two lists, then the two sub-problems, are independent, therefore,
+    // they can be computed in parallel.
+    ThreadBudget* budget = (std::min((StateIdx)(d.n2 - d.n1), d.c) >= d.parallel_size_min)?
+        d.budget: NULL;
+
+    BellmanStateList l1;
+    BellmanStateList l2;
+    fork_join(budget,
+            [&d, k, &l1]()
+            {
+                BellmanStateList tmp;
+                opts_bellman_list(d.instance, d.n1, k, d.c, d.j_max, l1, tmp, d.info);
+            },
+            [&d, k, &l2]()
+            {
+                BellmanStateList tmp;
+                opts_bellman_list(d.instance, k, d.n2, d.c, d.j_max, l2, tmp, d.info);
+            });
+    LOG(d.info, "l1.size " << l1.size << " l2.size " << l2.size << std::endl);
+
+    BellmanListJoin r = bellman_list_rec_join(l1, l2, d.c, 0, l1.size,
+            d.budget, d.parallel_size_min);
+    LOG(d.info, "z_max " << r.z << std::endl );
 
     if (d.n1 == k - 1)
-        if (l1[i1_opt].p == d.instance.item(d.n1).p)
-            d.sol.set(d.n1, true);
+        if (l1.p[r.i1 + 1] == d.instance.item(d.n1).p)
+            bellman_list_rec_set(d, d.n1);
     if (k == d.n2 - 1)
-        if (l2[i2_opt].p == d.instance.item(k).p)
-            d.sol.set(k, true);
-
-    if (d.n1 != k - 1)
-        bellman_list_rec_rec({
-                .instance = d.instance,
-                .n1 = d.n1,
-                .n2 = k,
-                .c = l1[i1_opt].w,
-                .sol = d.sol,
-                .j_max = d.j_max,
-                .info = d.info});
-    if (k != d.n2 - 1)
-        bellman_list_rec_rec({
-                .instance = d.instance,
-                .n1 = k,
-                .n2 = d.n2,
-                .c = l2[i2_opt].w,
-                .sol = d.sol,
-                .j_max = d.j_max,
-                .info = d.info});
+        if (l2.p[r.i2 + 1] == d.instance.item(k).p)
+            bellman_list_rec_set(d, k);
+    Weight c1 = l1.w[r.i1 + 1];
+    Weight c2 = l2.w[r.i2 + 1];
+
+    fork_join(budget,
+            [&d, k, c1]()
+            {
+                if (d.n1 != k - 1)
+                    bellman_list_rec_rec({
+                            .instance = d.instance,
+                            .n1 = d.n1,
+                            .n2 = k,
+                            .c = c1,
+                            .sol = d.sol,
+                            .j_max = d.j_max,
+                            .info = d.info,
+                            .budget = d.budget,
+                            .parallel_size_min = d.parallel_size_min,
+                            .sol_mutex = d.sol_mutex});
+            },
+            [&d, k, c2]()
+            {
+                if (k != d.n2 - 1)
+                    bellman_list_rec_rec({
+                            .instance = d.instance,
+                            .n1 = k,
+                            .n2 = d.n2,
+                            .c = c2,
+                            .sol = d.sol,
+                            .j_max = d.j_max,
+                            .info = d.info,
+                            .budget = d.budget,
+                            .parallel_size_min = d.parallel_size_min,
+                            .sol_mutex = d.sol_mutex});
+            });
 
     LOG_FOLD_END(d.info, "");
 }
 
-Output knapsacksolver::bellman_list_rec(const Instance& instance, Info info)
+Output bellman_list_rec_main(const Instance& instance,
+        ThreadBudget* budget, StateIdx parallel_size_min, Info& info)
 {
-    LOG_FOLD_START(info, "*** bellman (list, rec) ***" << std::endl);
-    VER(info, "*** bellman (list, rec) ***" << std::endl);
     Output output(instance, info);
     ItemPos n = instance.item_number();
 
@@ -841,6 +1898,7 @@ Output knapsacksolver::bellman_list_rec(const Instance& instance, Info info)
     }
 
     Solution sol(instance);
+    std::mutex sol_mutex;
     bellman_list_rec_rec({
         .instance = instance,
         .n1 = 0,
@@ -848,7 +1906,10 @@ Output knapsacksolver::bellman_list_rec(const Instance& instance, Info info)
         .c = instance.capacity(),
         .sol = sol,
         .j_max = j_max,
-        .info = info});
+        .info = info,
+        .budget = budget,
+        .parallel_size_min = parallel_size_min,
+        .sol_mutex = (budget != NULL)? &sol_mutex: NULL});
     if (!info.check_time()) {
         LOG_FOLD_END(info, "");
         return output.algorithm_end(info);
@@ -860,3 +1921,22 @@ Output knapsacksolver::bellman_list_rec(const Instance& instance, Info info)
     return output.algorithm_end(info);
 }
 
+Output knapsacksolver::bellman_list_rec(const Instance& instance, Info info)
+{
+    LOG_FOLD_START(info, "*** bellman (list, rec) ***" << std::endl);
+    VER(info, "*** bellman (list, rec) ***" << std::endl);
+    return bellman_list_rec_main(instance, NULL, 0, info);
+}
+
+/**************************** bellmanpar_list_rec *****************************/
+
+Output knapsacksolver::bellmanpar_list_rec(const Instance& instance,
+        Counter thread_number, StateIdx parallel_size_min, Info info)
+{
+    LOG_FOLD_START(info, "*** bellmanpar (list, rec) ***" << std::endl);
+    VER(info, "*** bellmanpar (list, rec) ***" << std::endl);
+    ThreadBudget budget(thread_number);
+    return bellman_list_rec_main(instance, &budget, parallel_size_min, info);
+}
+
+
@@ -6,15 +6,63 @@ namespace knapsacksolver
 {
 
 Output bellman_array(const Instance& instance, Info info = Info());
-Output bellmanpar_array(const Instance& instance, Info info = Info());
+/** Only for subset sum instances, i.e. instances such that p == w for all items.  */
+Output bellman_bitset(const Instance& instance, Info info = Info());
+Output bellmanpar_array(const Instance& instance, Counter partition_number = 2, Info info = Info());
+Output bellmanpar_array_capacity(const Instance& instance, Counter thread_number = 2, Info info = Info());
 Output bellmanrec(const Instance& instance, Info info = Info());
 Output bellman_array_all(const Instance& instance, Info info = Info());
+/**
+ * Same as bellman_array_all, but only one row of values and one bit per cell
+ * are stored.
+ */
+Output bellman_array_bits(const Instance& instance, Info info = Info());
+/**
+ * Same as bellman_array_bits, but the rows of bits are written to a scratch
+ * file in scratch_directory ($TMPDIR or /tmp if empty) instead of being kept
+ * in memory. If the scratch file cannot be created or written, falls back to
+ * bellman_array_bits.
+ */
+Output bellman_array_file(const Instance& instance, std::string scratch_directory = "", Info info = Info());
+/**
+ * Same as bellman_array_all, but only the rows before each block of k items
+ * are stored. During the retrieval of the optimal solution, the rows of each
+ * block are recomputed, which costs at most one more pass. k is chosen such
+ * that the table fits in memory_limit bytes if possible.
+ */
+Output bellman_array_checkpoint(const Instance& instance, StateIdx memory_limit = 0, Info info = Info());
+/**
+ * Same as bellman_array, but the items are sorted and, for each item, only
+ * the cells which may still lead to a better solution than the incumbent
+ * are updated.
+ */
+Output bellman_array_bounded(Instance& instance, Info info = Info());
 Output bellman_array_one(const Instance& instance, Info info = Info());
+/**
+ * Same as bellman_array, but for each capacity, the values of the last k
+ * items (k <= 512) in the best solution are also stored. Then, these items
+ * are fixed and the algorithm is run again on the other items.
+ */
 Output bellman_array_part(const Instance& instance, ItemIdx k=64, Info info = Info());
 Output bellman_array_rec(const Instance& instance, Info info = Info());
+/**
+ * Same as bellman_array_rec, but the sub-problems of size (n2 - n1) * (c + 1)
+ * of at least parallel_size_min are split between threads.
+ */
+const StateIdx BELLMANPAR_ARRAY_REC_MIN_SIZE = 1 << 16;
+Output bellmanpar_array_rec(const Instance& instance, Counter thread_number = 2,
+        StateIdx parallel_size_min = BELLMANPAR_ARRAY_REC_MIN_SIZE, Info info = Info());
 
 Output bellman_list(Instance& instance, bool sort = false, Info info = Info());
 Output bellman_list_rec(const Instance& instance, Info info = Info());
+/**
+ * Same as bellman_list_rec, but the sub-problems with at least
+ * parallel_size_min items and capacity, and the joins of lists with at least
+ * 2 * parallel_size_min states, are split between threads.
+ */
+const StateIdx BELLMANPAR_LIST_REC_MIN_SIZE = 1 << 12;
+Output bellmanpar_list_rec(const Instance& instance, Counter thread_number = 2,
+        StateIdx parallel_size_min = BELLMANPAR_LIST_REC_MIN_SIZE, Info info = Info());
 
 }
 
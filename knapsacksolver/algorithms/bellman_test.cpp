@@ -16,7 +16,23 @@ Output bellmanpar_array_test(Instance& ins)
     Info info = Info()
         //.set_verbose(true)
         ;
-    return bellmanpar_array(ins, info);
+    return bellmanpar_array(ins, 2, info);
+}
+
+Output bellmanpar_array_4_test(Instance& ins)
+{
+    Info info = Info()
+        //.set_verbose(true)
+        ;
+    return bellmanpar_array(ins, 4, info);
+}
+
+Output bellmanpar_array_capacity_test(Instance& ins)
+{
+    Info info = Info()
+        //.set_verbose(true)
+        ;
+    return bellmanpar_array_capacity(ins, 3, info);
 }
 
 Output bellmanrec_test(Instance& ins)
@@ -35,6 +51,30 @@ Output bellman_array_all_test(Instance& ins)
     return bellman_array_all(ins, info);
 }
 
+Output bellman_array_bits_test(Instance& ins)
+{
+    Info info = Info()
+        //.set_verbose(true)
+        ;
+    return bellman_array_bits(ins, info);
+}
+
+Output bellman_array_checkpoint_test(Instance& ins)
+{
+    Info info = Info()
+        //.set_verbose(true)
+        ;
+    return bellman_array_checkpoint(ins, 0, info);
+}
+
+Output bellman_array_checkpoint_2_test(Instance& ins)
+{
+    Info info = Info()
+        //.set_verbose(true)
+        ;
+    return bellman_array_checkpoint(ins, 1 << 10, info);
+}
+
 Output bellman_array_one_test(Instance& ins)
 {
     Info info = Info()
@@ -67,6 +107,14 @@ Output bellman_array_part3_test(Instance& ins)
     return bellman_array_part(ins, 3, info);
 }
 
+Output bellman_array_part200_test(Instance& ins)
+{
+    Info info = Info()
+        //.set_verbose(true)
+        ;
+    return bellman_array_part(ins, 200, info);
+}
+
 Output bellman_array_rec_test(Instance& ins)
 {
     Info info = Info()
@@ -75,6 +123,46 @@ Output bellman_array_rec_test(Instance& ins)
     return bellman_array_rec(ins, info);
 }
 
+Output bellmanpar_array_rec_test(Instance& ins)
+{
+    Info info = Info()
+        //.set_verbose(true)
+        ;
+    return bellmanpar_array_rec(ins, 3, BELLMANPAR_ARRAY_REC_MIN_SIZE, info);
+}
+
+Output bellmanpar_array_rec_split_test(Instance& ins)
+{
+    Info info = Info()
+        //.set_verbose(true)
+        ;
+    return bellmanpar_array_rec(ins, 4, 0, info);
+}
+
+Output bellman_array_file_test(Instance& ins)
+{
+    Info info = Info()
+        //.set_verbose(true)
+        ;
+    return bellman_array_file(ins, "", info);
+}
+
+Output bellman_array_file_nodir_test(Instance& ins)
+{
+    Info info = Info()
+        //.set_verbose(true)
+        ;
+    return bellman_array_file(ins, "/knapsacksolver_nonexistent", info);
+}
+
+Output bellman_array_bounded_test(Instance& ins)
+{
+    Info info = Info()
+        //.set_verbose(true)
+        ;
+    return bellman_array_bounded(ins, info);
+}
+
 Output bellman_list_test(Instance& ins)
 {
     Info info = Info()
@@ -99,27 +187,70 @@ Output bellman_list_rec_test(Instance& ins)
     return bellman_list_rec(ins, info);
 }
 
+Output bellmanpar_list_rec_test(Instance& ins)
+{
+    Info info = Info()
+        //.set_verbose(true)
+        ;
+    return bellmanpar_list_rec(ins, 3, BELLMANPAR_LIST_REC_MIN_SIZE, info);
+}
+
+Output bellmanpar_list_rec_split_test(Instance& ins)
+{
+    Info info = Info()
+        //.set_verbose(true)
+        ;
+    return bellmanpar_list_rec(ins, 4, 0, info);
+}
+
+Output bellman_bitset_test(Instance& ins)
+{
+    Info info = Info()
+        //.set_verbose(true)
+        ;
+    return bellman_bitset(ins, info);
+}
+
 std::vector<Output (*)(Instance&)> f_sopt {
         bellman_array_test,
         bellmanrec_test,
         bellman_array_all_test,
+        bellman_array_bits_test,
+        bellman_array_file_test,
+        bellman_array_file_nodir_test,
+        bellman_array_checkpoint_test,
+        bellman_array_checkpoint_2_test,
         bellman_array_one_test,
         bellman_array_part1_test,
         bellman_array_part2_test,
         bellman_array_part3_test,
+        bellman_array_part200_test,
         bellman_array_rec_test,
+        bellmanpar_array_rec_test,
+        bellmanpar_array_rec_split_test,
+        bellmanpar_array_test,
+        bellmanpar_array_4_test,
         bellman_list_rec_test,
+        bellmanpar_list_rec_test,
+        bellmanpar_list_rec_split_test,
 };
 
 std::vector<Output (*)(Instance&)> f_opt {
         bellman_array_test,
-        bellmanpar_array_test,
+        bellmanpar_array_capacity_test,
+        bellman_array_bounded_test,
         bellman_list_test,
         bellman_list_sort_test,
 };
 
+std::vector<Output (*)(Instance&)> f_subsetsum {
+        bellman_array_all_test,
+        bellman_bitset_test,
+};
+
 TEST(bellman, TEST_SOPT)  { test(TEST, f_sopt, SOPT); }
 TEST(bellman, SMALL_SOPT) { test(SMALL, f_sopt, SOPT); }
 TEST(bellman, TEST_OPT)  { test(TEST, f_opt, OPT); }
 TEST(bellman, SMALL_OPT) { test(SMALL, f_opt, OPT); }
+TEST(bellman, SUBSETSUM_SOPT) { test(SUBSETSUM, f_subsetsum, SOPT); }
 
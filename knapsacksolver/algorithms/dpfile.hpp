@@ -0,0 +1,247 @@
+#pragma once
+
+#include "knapsacksolver/instance.hpp"
+
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define KNAPSACKSOLVER_DPFILE_MMAP
+#endif
+
+namespace knapsacksolver
+{
+
+/**
+ * Size in bytes of the chunks written to the scratch file. Rows are gathered
+ * in a buffer of this size, so that the file is written with large
+ * sequential writes.
+ */
+const StateIdx DP_ROW_FILE_CHUNK_BYTES = 1 << 26;
+
+/**
+ * Rows of a DP table, for example the decision bits of the rows of
+ * bellman_array_bits, stored in a scratch file instead of in memory.
+ *
+ * The rows are appended in increasing order during the forward pass. Then,
+ * the file is memory-mapped read-only, or read row by row if it cannot be
+ * mapped, and the rows are read in decreasing order during the retrieval of
+ * the solution. The file is deleted as soon as it is created, so it doesn't
+ * outlive the process.
+ *
+ * On systems without mmap, the rows are kept in memory.
+ */
+class DpRowFile
+{
+
+public:
+
+    /**
+     * Create a scratch file in directory for row_number rows of row_size
+     * bytes. If directory is empty, $TMPDIR or /tmp is used.
+     */
+    DpRowFile(std::string directory, StateIdx row_size, StateIdx row_number):
+        row_size_(row_size), row_number_(row_number)
+    {
+#if defined(KNAPSACKSOLVER_DPFILE_MMAP)
+        if (directory.empty())
+            directory = (getenv("TMPDIR") != NULL)? getenv("TMPDIR"): "/tmp";
+        std::string path = directory + "/knapsacksolver_XXXXXX";
+        std::vector<char> path_c(path.begin(), path.end());
+        path_c.push_back('\0');
+        fd_ = mkstemp(path_c.data());
+        if (fd_ == -1)
+            return;
+        unlink(path_c.data());
+        if (ftruncate(fd_, size()) != 0) {
+            close(fd_);
+            fd_ = -1;
+            return;
+        }
+        buffer_.reserve(std::min(size(), std::max(row_size_, DP_ROW_FILE_CHUNK_BYTES)));
+#else
+        buffer_.reserve(size());
+#endif
+    }
+
+    ~DpRowFile()
+    {
+#if defined(KNAPSACKSOLVER_DPFILE_MMAP)
+        if (data_ != NULL)
+            munmap((void*)data_, size());
+        if (fd_ != -1)
+            close(fd_);
+#endif
+    }
+
+    DpRowFile(const DpRowFile&) = delete;
+    DpRowFile& operator=(const DpRowFile&) = delete;
+
+    /** Return false if the scratch file could not be created or written.  */
+    bool ok() const
+    {
+#if defined(KNAPSACKSOLVER_DPFILE_MMAP)
+        return fd_ != -1;
+#else
+        return true;
+#endif
+    }
+
+    /** Append the next row.  */
+    void append(const void* row)
+    {
+#if defined(KNAPSACKSOLVER_DPFILE_MMAP)
+        if ((StateIdx)buffer_.size() + row_size_ > (StateIdx)buffer_.capacity())
+            flush();
+#endif
+        const char* r = (const char*)row;
+        buffer_.insert(buffer_.end(), r, r + row_size_);
+    }
+
+    /**
+     * Finish the forward pass. The rows can then be read with row().
+     */
+    void finish()
+    {
+#if defined(KNAPSACKSOLVER_DPFILE_MMAP)
+        flush();
+        if (fd_ == -1 || size() == 0)
+            return;
+        void* data = mmap(NULL, size(), PROT_READ, MAP_SHARED, fd_, 0);
+        if (data == MAP_FAILED) {
+            // For example, the address space is limited. The rows are then
+            // read one by one.
+            row_buffer_.resize(row_size_);
+            return;
+        }
+        // Only a few words of each row are read.
+        madvise(data, size(), MADV_RANDOM);
+        data_ = (const char*)data;
+#else
+        data_ = buffer_.data();
+#endif
+    }
+
+    /**
+     * Return row j. If the file could not be mapped, the pointer is only
+     * valid until the next call.
+     */
+    const char* row(StateIdx j) const
+    {
+#if defined(KNAPSACKSOLVER_DPFILE_MMAP)
+        if (data_ == NULL) {
+            if (pread(fd_, row_buffer_.data(), row_size_, j * row_size_) != (ssize_t)row_size_)
+                std::fill(row_buffer_.begin(), row_buffer_.end(), 0);
+            return row_buffer_.data();
+        }
+#endif
+        return data_ + j * row_size_;
+    }
+
+    /**
+     * Announce that bytes [offset, offset + len) of row j will be read soon.
+     */
+    void prefetch(StateIdx j, StateIdx offset, StateIdx len) const
+    {
+#if defined(KNAPSACKSOLVER_DPFILE_MMAP)
+        if (data_ == NULL)
+            return;
+        static const StateIdx page_size = sysconf(_SC_PAGESIZE);
+        StateIdx begin = (j * row_size_ + offset) / page_size * page_size;
+        StateIdx end = j * row_size_ + offset + len;
+        madvise((void*)(data_ + begin), end - begin, MADV_WILLNEED);
+#else
+        (void)j;
+        (void)offset;
+        (void)len;
+#endif
+    }
+
+private:
+
+    StateIdx size() const { return row_size_ * row_number_; }
+
+#if defined(KNAPSACKSOLVER_DPFILE_MMAP)
+    void flush()
+    {
+        const char* p = buffer_.data();
+        StateIdx len = buffer_.size();
+        while (fd_ != -1 && len > 0) {
+            ssize_t written = pwrite(fd_, p, len, offset_);
+            if (written <= 0) {
+                close(fd_);
+                fd_ = -1;
+                break;
+            }
+            p += written;
+            len -= written;
+            offset_ += written;
+        }
+        buffer_.clear();
+    }
+
+    int fd_ = -1;
+    StateIdx offset_ = 0;
+    mutable std::vector<char> row_buffer_;
+#endif
+
+    StateIdx row_size_;
+    StateIdx row_number_;
+    std::vector<char> buffer_;
+    const char* data_ = NULL;
+
+};
+
+/**
+ * Same interface as DpRowFile, but the rows are kept in memory. It is used
+ * when the table of decision bits fits in memory; ok() returns false if it
+ * cannot be allocated.
+ */
+class DpRowMemory
+{
+
+public:
+
+    DpRowMemory(StateIdx row_size, StateIdx row_number):
+        row_size_(row_size)
+    {
+        try {
+            rows_.reserve(row_size * row_number);
+        } catch (const std::bad_alloc&) {
+            ok_ = false;
+        }
+    }
+
+    /** Return false if the rows could not be allocated.  */
+    bool ok() const { return ok_; }
+
+    /** Append the next row.  */
+    void append(const void* row)
+    {
+        const char* r = (const char*)row;
+        rows_.insert(rows_.end(), r, r + row_size_);
+    }
+
+    /** Finish the forward pass.  */
+    void finish() { }
+
+    /** Return row j.  */
+    const char* row(StateIdx j) const { return rows_.data() + j * row_size_; }
+
+    /** Nothing to do, the rows are in memory.  */
+    void prefetch(StateIdx, StateIdx, StateIdx) const { }
+
+private:
+
+    StateIdx row_size_;
+    std::vector<char> rows_;
+    bool ok_ = true;
+
+};
+
+}
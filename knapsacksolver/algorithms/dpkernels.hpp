@@ -0,0 +1,632 @@
+#pragma once
+
+#include "knapsacksolver/instance.hpp"
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace knapsacksolver
+{
+
+/**
+ * Inner loops of the array dynamic programming algorithms.
+ *
+ * The AVX-512 (resp. AVX2) versions are compiled when the corresponding
+ * instruction set is enabled, for example with "--copt=-march=native".
+ * Otherwise, a scalar loop is used.
+ *
+ * The kernels are templated on the type of the values of the DP table. Using
+ * 32 or 16 bits integers when the values are small enough divides the memory
+ * bandwidth by 2 or 4 and multiplies the number of SIMD lanes accordingly.
+ */
+
+/**
+ * v[i] = max(v0[i], v1[i] + pj) for i = len - 1, ..., 0.
+ *
+ * Cells are processed by non-increasing index, therefore the classical
+ * in-place update of the capacity DP:
+ *     for (Weight w = c; w >= wj; w--)
+ *         values[w] = max(values[w], values[w - wj] + pj);
+ * is obtained with v0 = v = values + wj, v1 = values and len = c - wj + 1:
+ * each value values[w - wj] is read before being overwritten.
+ *
+ * v1[i] + pj must fit in T.
+ */
+template <typename T>
+inline void bellman_array_update(
+        const T* v0, const T* v1, T* v, Weight len, T pj);
+
+/**
+ * Same as bellman_array_update, and moreover, set bit "bit + i" of the bitset
+ * "taken" for each i such that v1[i] + pj > v0[i].
+ */
+template <typename T>
+inline void bellman_array_update_bits(
+        const T* v0, const T* v1, T* v, Weight len, T pj,
+        uint64_t* taken, Weight bit);
+
+/** Number of cells of the tiles of the cache-blocked kernels.  */
+const Weight BELLMAN_ARRAY_TILE_SIZE = 4096;
+
+/**
+ * Size in bytes of the intermediate rows of the cache-blocked kernels. It
+ * should be of the order of the size of the L2 cache.
+ */
+const StateIdx BELLMAN_ARRAY_BLOCK_BYTES = 1 << 20;
+
+/**
+ * Apply items 0, ..., m - 1 of weights w[0], ..., w[m - 1] (<= c) and
+ * profits p[0], ..., p[m - 1] to the capacity DP table values[0..c].
+ *
+ * Instead of streaming the whole table once per item, the table is processed
+ * by tiles of increasing capacities and all the items are applied to a tile
+ * before moving to the next one. Row k (before item k) is kept in a ring
+ * buffer of ring_size >= max(w) + tile_size cells, which contains all the
+ * cells that remain to be read by the next tiles. Therefore, the table is
+ * read and written once for the m items instead of m times.
+ *
+ * buffer is resized to m * ring_size.
+ */
+template <typename T>
+inline void bellman_array_update_tiled(
+        T* values, Weight c, const Weight* w, const T* p, ItemIdx m,
+        std::vector<T>& buffer, Weight tile_size = BELLMAN_ARRAY_TILE_SIZE);
+
+/**
+ * Return the size in bytes (2, 4 or 8) of the smallest signed integer type
+ * which can store all values between 0 and bound.
+ */
+inline int dp_value_size(Profit bound);
+
+/**
+ * v[i] = min(v0[i], v1[i] + wj) for i = len - 1, ..., 0.
+ *
+ * Min-plus counterpart of bellman_array_update for the profit DP, in which
+ * values[q] is the minimum weight of a solution of profit q. The in-place
+ * update is obtained with v0 = v = values + pj, v1 = values and
+ * len = ub - pj + 1.
+ *
+ * v1[i] + wj must fit in T.
+ */
+template <typename T>
+inline void dpprofits_array_update(
+        const T* v0, const T* v1, T* v, Weight len, T wj);
+
+/**
+ * Same as dpprofits_array_update, and moreover, set bit "bit + i" of the
+ * bitset "taken" for each i such that v1[i] + wj < v0[i].
+ */
+template <typename T>
+inline void dpprofits_array_update_bits(
+        const T* v0, const T* v1, T* v, Weight len, T wj,
+        uint64_t* taken, Weight bit);
+
+/**
+ * Return the largest i < len such that v[i] <= c, or -1 if there is none.
+ *
+ * It is used to retrieve the best solution of a profit DP table with a
+ * single pass per item instead of a test per updated cell.
+ */
+template <typename T>
+inline Weight dpprofits_array_last_fit(const T* v, Weight len, T c);
+
+/******************************************************************************/
+
+template <typename T>
+inline void bellman_array_update_scalar(
+        const T* v0, const T* v1, T* v, Weight len, T pj)
+{
+    for (Weight i = len; i > 0; --i) {
+        T x = v1[i - 1] + pj;
+        if (v0[i - 1] < x) {
+            v[i - 1] = x;
+        } else if (v != v0) {
+            v[i - 1] = v0[i - 1];
+        }
+    }
+}
+
+template <typename T>
+inline void bellman_array_update(
+        const T* v0, const T* v1, T* v, Weight len, T pj)
+{
+    bellman_array_update_scalar(v0, v1, v, len, pj);
+}
+
+template <>
+inline void bellman_array_update<int64_t>(
+        const int64_t* v0, const int64_t* v1, int64_t* v, Weight len, int64_t pj)
+{
+    Weight i = len;
+#if defined(__AVX512F__)
+    const __m512i p = _mm512_set1_epi64(pj);
+    for (; i >= 8; i -= 8) {
+        __m512i a = _mm512_loadu_si512((const void*)(v0 + i - 8));
+        __m512i b = _mm512_add_epi64(_mm512_loadu_si512((const void*)(v1 + i - 8)), p);
+        _mm512_storeu_si512((void*)(v + i - 8), _mm512_max_epi64(a, b));
+    }
+#elif defined(__AVX2__)
+    const __m256i p = _mm256_set1_epi64x(pj);
+    for (; i >= 4; i -= 4) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(v0 + i - 4));
+        __m256i b = _mm256_add_epi64(_mm256_loadu_si256((const __m256i*)(v1 + i - 4)), p);
+        _mm256_storeu_si256((__m256i*)(v + i - 4),
+                _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(b, a)));
+    }
+#endif
+    bellman_array_update_scalar(v0, v1, v, i, pj);
+}
+
+template <>
+inline void bellman_array_update<int32_t>(
+        const int32_t* v0, const int32_t* v1, int32_t* v, Weight len, int32_t pj)
+{
+    Weight i = len;
+#if defined(__AVX512F__)
+    const __m512i p = _mm512_set1_epi32(pj);
+    for (; i >= 16; i -= 16) {
+        __m512i a = _mm512_loadu_si512((const void*)(v0 + i - 16));
+        __m512i b = _mm512_add_epi32(_mm512_loadu_si512((const void*)(v1 + i - 16)), p);
+        _mm512_storeu_si512((void*)(v + i - 16), _mm512_max_epi32(a, b));
+    }
+#elif defined(__AVX2__)
+    const __m256i p = _mm256_set1_epi32(pj);
+    for (; i >= 8; i -= 8) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(v0 + i - 8));
+        __m256i b = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(v1 + i - 8)), p);
+        _mm256_storeu_si256((__m256i*)(v + i - 8), _mm256_max_epi32(a, b));
+    }
+#endif
+    bellman_array_update_scalar(v0, v1, v, i, pj);
+}
+
+template <>
+inline void bellman_array_update<int16_t>(
+        const int16_t* v0, const int16_t* v1, int16_t* v, Weight len, int16_t pj)
+{
+    Weight i = len;
+#if defined(__AVX512BW__)
+    const __m512i p = _mm512_set1_epi16(pj);
+    for (; i >= 32; i -= 32) {
+        __m512i a = _mm512_loadu_si512((const void*)(v0 + i - 32));
+        __m512i b = _mm512_add_epi16(_mm512_loadu_si512((const void*)(v1 + i - 32)), p);
+        _mm512_storeu_si512((void*)(v + i - 32), _mm512_max_epi16(a, b));
+    }
+#elif defined(__AVX2__)
+    const __m256i p = _mm256_set1_epi16(pj);
+    for (; i >= 16; i -= 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(v0 + i - 16));
+        __m256i b = _mm256_add_epi16(_mm256_loadu_si256((const __m256i*)(v1 + i - 16)), p);
+        _mm256_storeu_si256((__m256i*)(v + i - 16), _mm256_max_epi16(a, b));
+    }
+#endif
+    bellman_array_update_scalar(v0, v1, v, i, pj);
+}
+
+template <typename T>
+inline void bellman_array_update_tiled(
+        T* values, Weight c, const Weight* w, const T* p, ItemIdx m,
+        std::vector<T>& buffer, Weight tile_size)
+{
+    Weight w_max = 0;
+    for (ItemIdx k = 0; k < m; ++k)
+        w_max = std::max(w_max, w[k]);
+    // ring_size is a multiple of tile_size, so that a tile is contiguous in
+    // the ring buffers.
+    Weight ring_size = (w_max + 2 * tile_size - 1) / tile_size * tile_size;
+    buffer.resize(m * ring_size);
+
+    for (Weight a = 0; a <= c; a += tile_size) {
+        Weight len = std::min(tile_size, c + 1 - a);
+        Weight o = a % ring_size;
+        std::copy(values + a, values + a + len, buffer.data() + o);
+        for (ItemIdx k = 0; k < m; ++k) {
+            const T* src = buffer.data() + k * ring_size;
+            T* dst = (k == m - 1)? values + a: buffer.data() + (k + 1) * ring_size + o;
+            // Cells a, ..., a + i - 1 are smaller than w[k].
+            Weight i = std::max((Weight)0, std::min(w[k] - a, len));
+            std::copy(src + o, src + o + i, dst);
+            while (i < len) {
+                // Cells (a + i - w[k]) % ring_size, ... are contiguous until
+                // the end of the ring buffer.
+                Weight s = (a + i - w[k]) % ring_size;
+                Weight l = std::min(len - i, ring_size - s);
+                bellman_array_update(src + o + i, src + s, dst + i, l, p[k]);
+                i += l;
+            }
+        }
+    }
+}
+
+/** Set bits pos, ..., pos + nbits - 1 (nbits <= 64) of bitset to mask.  */
+inline void bellman_array_set_bits(uint64_t* bitset, Weight pos, uint64_t mask, Weight nbits)
+{
+    Weight q = pos / 64;
+    Weight r = pos % 64;
+    bitset[q] |= mask << r;
+    if (r + nbits > 64)
+        bitset[q + 1] |= mask >> (64 - r);
+}
+
+template <typename T>
+inline void bellman_array_update_bits_scalar(
+        const T* v0, const T* v1, T* v, Weight len, T pj,
+        uint64_t* taken, Weight bit)
+{
+    for (Weight i = len; i > 0; --i) {
+        T x = v1[i - 1] + pj;
+        if (v0[i - 1] < x) {
+            v[i - 1] = x;
+            taken[(bit + i - 1) / 64] |= (uint64_t)1 << ((bit + i - 1) % 64);
+        } else if (v != v0) {
+            v[i - 1] = v0[i - 1];
+        }
+    }
+}
+
+template <typename T>
+inline void bellman_array_update_bits(
+        const T* v0, const T* v1, T* v, Weight len, T pj,
+        uint64_t* taken, Weight bit)
+{
+    bellman_array_update_bits_scalar(v0, v1, v, len, pj, taken, bit);
+}
+
+template <>
+inline void bellman_array_update_bits<int64_t>(
+        const int64_t* v0, const int64_t* v1, int64_t* v, Weight len, int64_t pj,
+        uint64_t* taken, Weight bit)
+{
+    Weight i = len;
+#if defined(__AVX512F__)
+    const __m512i p = _mm512_set1_epi64(pj);
+    for (; i >= 8; i -= 8) {
+        __m512i a = _mm512_loadu_si512((const void*)(v0 + i - 8));
+        __m512i b = _mm512_add_epi64(_mm512_loadu_si512((const void*)(v1 + i - 8)), p);
+        _mm512_storeu_si512((void*)(v + i - 8), _mm512_max_epi64(a, b));
+        bellman_array_set_bits(taken, bit + i - 8, _mm512_cmpgt_epi64_mask(b, a), 8);
+    }
+#elif defined(__AVX2__)
+    const __m256i p = _mm256_set1_epi64x(pj);
+    for (; i >= 4; i -= 4) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(v0 + i - 4));
+        __m256i b = _mm256_add_epi64(_mm256_loadu_si256((const __m256i*)(v1 + i - 4)), p);
+        __m256i gt = _mm256_cmpgt_epi64(b, a);
+        _mm256_storeu_si256((__m256i*)(v + i - 4), _mm256_blendv_epi8(a, b, gt));
+        bellman_array_set_bits(taken, bit + i - 4,
+                _mm256_movemask_pd(_mm256_castsi256_pd(gt)), 4);
+    }
+#endif
+    bellman_array_update_bits_scalar(v0, v1, v, i, pj, taken, bit);
+}
+
+template <>
+inline void bellman_array_update_bits<int32_t>(
+        const int32_t* v0, const int32_t* v1, int32_t* v, Weight len, int32_t pj,
+        uint64_t* taken, Weight bit)
+{
+    Weight i = len;
+#if defined(__AVX512F__)
+    const __m512i p = _mm512_set1_epi32(pj);
+    for (; i >= 16; i -= 16) {
+        __m512i a = _mm512_loadu_si512((const void*)(v0 + i - 16));
+        __m512i b = _mm512_add_epi32(_mm512_loadu_si512((const void*)(v1 + i - 16)), p);
+        _mm512_storeu_si512((void*)(v + i - 16), _mm512_max_epi32(a, b));
+        bellman_array_set_bits(taken, bit + i - 16, _mm512_cmpgt_epi32_mask(b, a), 16);
+    }
+#elif defined(__AVX2__)
+    const __m256i p = _mm256_set1_epi32(pj);
+    for (; i >= 8; i -= 8) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(v0 + i - 8));
+        __m256i b = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(v1 + i - 8)), p);
+        _mm256_storeu_si256((__m256i*)(v + i - 8), _mm256_max_epi32(a, b));
+        bellman_array_set_bits(taken, bit + i - 8,
+                _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(b, a))), 8);
+    }
+#endif
+    bellman_array_update_bits_scalar(v0, v1, v, i, pj, taken, bit);
+}
+
+#if defined(__AVX512BW__)
+template <>
+inline void bellman_array_update_bits<int16_t>(
+        const int16_t* v0, const int16_t* v1, int16_t* v, Weight len, int16_t pj,
+        uint64_t* taken, Weight bit)
+{
+    Weight i = len;
+    const __m512i p = _mm512_set1_epi16(pj);
+    for (; i >= 32; i -= 32) {
+        __m512i a = _mm512_loadu_si512((const void*)(v0 + i - 32));
+        __m512i b = _mm512_add_epi16(_mm512_loadu_si512((const void*)(v1 + i - 32)), p);
+        _mm512_storeu_si512((void*)(v + i - 32), _mm512_max_epi16(a, b));
+        bellman_array_set_bits(taken, bit + i - 32, _mm512_cmpgt_epi16_mask(b, a), 32);
+    }
+    bellman_array_update_bits_scalar(v0, v1, v, i, pj, taken, bit);
+}
+#endif
+
+template <typename T>
+inline void dpprofits_array_update_scalar(
+        const T* v0, const T* v1, T* v, Weight len, T wj)
+{
+    for (Weight i = len; i > 0; --i) {
+        T x = v1[i - 1] + wj;
+        if (v0[i - 1] > x) {
+            v[i - 1] = x;
+        } else if (v != v0) {
+            v[i - 1] = v0[i - 1];
+        }
+    }
+}
+
+template <typename T>
+inline void dpprofits_array_update(
+        const T* v0, const T* v1, T* v, Weight len, T wj)
+{
+    dpprofits_array_update_scalar(v0, v1, v, len, wj);
+}
+
+template <>
+inline void dpprofits_array_update<int64_t>(
+        const int64_t* v0, const int64_t* v1, int64_t* v, Weight len, int64_t wj)
+{
+    Weight i = len;
+#if defined(__AVX512F__)
+    const __m512i w = _mm512_set1_epi64(wj);
+    for (; i >= 8; i -= 8) {
+        __m512i a = _mm512_loadu_si512((const void*)(v0 + i - 8));
+        __m512i b = _mm512_add_epi64(_mm512_loadu_si512((const void*)(v1 + i - 8)), w);
+        _mm512_storeu_si512((void*)(v + i - 8), _mm512_min_epi64(a, b));
+    }
+#elif defined(__AVX2__)
+    const __m256i w = _mm256_set1_epi64x(wj);
+    for (; i >= 4; i -= 4) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(v0 + i - 4));
+        __m256i b = _mm256_add_epi64(_mm256_loadu_si256((const __m256i*)(v1 + i - 4)), w);
+        _mm256_storeu_si256((__m256i*)(v + i - 4),
+                _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b)));
+    }
+#endif
+    dpprofits_array_update_scalar(v0, v1, v, i, wj);
+}
+
+template <>
+inline void dpprofits_array_update<int32_t>(
+        const int32_t* v0, const int32_t* v1, int32_t* v, Weight len, int32_t wj)
+{
+    Weight i = len;
+#if defined(__AVX512F__)
+    const __m512i w = _mm512_set1_epi32(wj);
+    for (; i >= 16; i -= 16) {
+        __m512i a = _mm512_loadu_si512((const void*)(v0 + i - 16));
+        __m512i b = _mm512_add_epi32(_mm512_loadu_si512((const void*)(v1 + i - 16)), w);
+        _mm512_storeu_si512((void*)(v + i - 16), _mm512_min_epi32(a, b));
+    }
+#elif defined(__AVX2__)
+    const __m256i w = _mm256_set1_epi32(wj);
+    for (; i >= 8; i -= 8) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(v0 + i - 8));
+        __m256i b = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(v1 + i - 8)), w);
+        _mm256_storeu_si256((__m256i*)(v + i - 8), _mm256_min_epi32(a, b));
+    }
+#endif
+    dpprofits_array_update_scalar(v0, v1, v, i, wj);
+}
+
+template <>
+inline void dpprofits_array_update<int16_t>(
+        const int16_t* v0, const int16_t* v1, int16_t* v, Weight len, int16_t wj)
+{
+    Weight i = len;
+#if defined(__AVX512BW__)
+    const __m512i w = _mm512_set1_epi16(wj);
+    for (; i >= 32; i -= 32) {
+        __m512i a = _mm512_loadu_si512((const void*)(v0 + i - 32));
+        __m512i b = _mm512_add_epi16(_mm512_loadu_si512((const void*)(v1 + i - 32)), w);
+        _mm512_storeu_si512((void*)(v + i - 32), _mm512_min_epi16(a, b));
+    }
+#elif defined(__AVX2__)
+    const __m256i w = _mm256_set1_epi16(wj);
+    for (; i >= 16; i -= 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(v0 + i - 16));
+        __m256i b = _mm256_add_epi16(_mm256_loadu_si256((const __m256i*)(v1 + i - 16)), w);
+        _mm256_storeu_si256((__m256i*)(v + i - 16), _mm256_min_epi16(a, b));
+    }
+#endif
+    dpprofits_array_update_scalar(v0, v1, v, i, wj);
+}
+
+template <typename T>
+inline void dpprofits_array_update_bits_scalar(
+        const T* v0, const T* v1, T* v, Weight len, T wj,
+        uint64_t* taken, Weight bit)
+{
+    for (Weight i = len; i > 0; --i) {
+        T x = v1[i - 1] + wj;
+        if (v0[i - 1] > x) {
+            v[i - 1] = x;
+            taken[(bit + i - 1) / 64] |= (uint64_t)1 << ((bit + i - 1) % 64);
+        } else if (v != v0) {
+            v[i - 1] = v0[i - 1];
+        }
+    }
+}
+
+template <typename T>
+inline void dpprofits_array_update_bits(
+        const T* v0, const T* v1, T* v, Weight len, T wj,
+        uint64_t* taken, Weight bit)
+{
+    dpprofits_array_update_bits_scalar(v0, v1, v, len, wj, taken, bit);
+}
+
+template <>
+inline void dpprofits_array_update_bits<int64_t>(
+        const int64_t* v0, const int64_t* v1, int64_t* v, Weight len, int64_t wj,
+        uint64_t* taken, Weight bit)
+{
+    Weight i = len;
+#if defined(__AVX512F__)
+    const __m512i w = _mm512_set1_epi64(wj);
+    for (; i >= 8; i -= 8) {
+        __m512i a = _mm512_loadu_si512((const void*)(v0 + i - 8));
+        __m512i b = _mm512_add_epi64(_mm512_loadu_si512((const void*)(v1 + i - 8)), w);
+        _mm512_storeu_si512((void*)(v + i - 8), _mm512_min_epi64(a, b));
+        bellman_array_set_bits(taken, bit + i - 8, _mm512_cmpgt_epi64_mask(a, b), 8);
+    }
+#elif defined(__AVX2__)
+    const __m256i w = _mm256_set1_epi64x(wj);
+    for (; i >= 4; i -= 4) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(v0 + i - 4));
+        __m256i b = _mm256_add_epi64(_mm256_loadu_si256((const __m256i*)(v1 + i - 4)), w);
+        __m256i gt = _mm256_cmpgt_epi64(a, b);
+        _mm256_storeu_si256((__m256i*)(v + i - 4), _mm256_blendv_epi8(a, b, gt));
+        bellman_array_set_bits(taken, bit + i - 4,
+                _mm256_movemask_pd(_mm256_castsi256_pd(gt)), 4);
+    }
+#endif
+    dpprofits_array_update_bits_scalar(v0, v1, v, i, wj, taken, bit);
+}
+
+template <>
+inline void dpprofits_array_update_bits<int32_t>(
+        const int32_t* v0, const int32_t* v1, int32_t* v, Weight len, int32_t wj,
+        uint64_t* taken, Weight bit)
+{
+    Weight i = len;
+#if defined(__AVX512F__)
+    const __m512i w = _mm512_set1_epi32(wj);
+    for (; i >= 16; i -= 16) {
+        __m512i a = _mm512_loadu_si512((const void*)(v0 + i - 16));
+        __m512i b = _mm512_add_epi32(_mm512_loadu_si512((const void*)(v1 + i - 16)), w);
+        _mm512_storeu_si512((void*)(v + i - 16), _mm512_min_epi32(a, b));
+        bellman_array_set_bits(taken, bit + i - 16, _mm512_cmpgt_epi32_mask(a, b), 16);
+    }
+#elif defined(__AVX2__)
+    const __m256i w = _mm256_set1_epi32(wj);
+    for (; i >= 8; i -= 8) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(v0 + i - 8));
+        __m256i b = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(v1 + i - 8)), w);
+        _mm256_storeu_si256((__m256i*)(v + i - 8), _mm256_min_epi32(a, b));
+        bellman_array_set_bits(taken, bit + i - 8,
+                _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(a, b))), 8);
+    }
+#endif
+    dpprofits_array_update_bits_scalar(v0, v1, v, i, wj, taken, bit);
+}
+
+#if defined(__AVX512BW__)
+template <>
+inline void dpprofits_array_update_bits<int16_t>(
+        const int16_t* v0, const int16_t* v1, int16_t* v, Weight len, int16_t wj,
+        uint64_t* taken, Weight bit)
+{
+    Weight i = len;
+    const __m512i w = _mm512_set1_epi16(wj);
+    for (; i >= 32; i -= 32) {
+        __m512i a = _mm512_loadu_si512((const void*)(v0 + i - 32));
+        __m512i b = _mm512_add_epi16(_mm512_loadu_si512((const void*)(v1 + i - 32)), w);
+        _mm512_storeu_si512((void*)(v + i - 32), _mm512_min_epi16(a, b));
+        bellman_array_set_bits(taken, bit + i - 32, _mm512_cmpgt_epi16_mask(a, b), 32);
+    }
+    dpprofits_array_update_bits_scalar(v0, v1, v, i, wj, taken, bit);
+}
+#endif
+
+template <typename T>
+inline Weight dpprofits_array_last_fit_scalar(const T* v, Weight len, T c)
+{
+    for (Weight i = len - 1; i >= 0; --i)
+        if (v[i] <= c)
+            return i;
+    return -1;
+}
+
+template <typename T>
+inline Weight dpprofits_array_last_fit(const T* v, Weight len, T c)
+{
+    return dpprofits_array_last_fit_scalar(v, len, c);
+}
+
+template <>
+inline Weight dpprofits_array_last_fit<int64_t>(const int64_t* v, Weight len, int64_t c)
+{
+    Weight i = len;
+#if defined(__AVX512F__)
+    const __m512i cc = _mm512_set1_epi64(c);
+    for (; i >= 8; i -= 8) {
+        __mmask8 m = _mm512_cmple_epi64_mask(_mm512_loadu_si512((const void*)(v + i - 8)), cc);
+        if (m != 0)
+            return i - 8 + 31 - __builtin_clz(m);
+    }
+#elif defined(__AVX2__)
+    const __m256i cc = _mm256_set1_epi64x(c);
+    for (; i >= 4; i -= 4) {
+        __m256i gt = _mm256_cmpgt_epi64(_mm256_loadu_si256((const __m256i*)(v + i - 4)), cc);
+        int m = ~_mm256_movemask_pd(_mm256_castsi256_pd(gt)) & 0xF;
+        if (m != 0)
+            return i - 4 + 31 - __builtin_clz(m);
+    }
+#endif
+    return dpprofits_array_last_fit_scalar(v, i, c);
+}
+
+template <>
+inline Weight dpprofits_array_last_fit<int32_t>(const int32_t* v, Weight len, int32_t c)
+{
+    Weight i = len;
+#if defined(__AVX512F__)
+    const __m512i cc = _mm512_set1_epi32(c);
+    for (; i >= 16; i -= 16) {
+        __mmask16 m = _mm512_cmple_epi32_mask(_mm512_loadu_si512((const void*)(v + i - 16)), cc);
+        if (m != 0)
+            return i - 16 + 31 - __builtin_clz(m);
+    }
+#elif defined(__AVX2__)
+    const __m256i cc = _mm256_set1_epi32(c);
+    for (; i >= 8; i -= 8) {
+        __m256i gt = _mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i*)(v + i - 8)), cc);
+        int m = ~_mm256_movemask_ps(_mm256_castsi256_ps(gt)) & 0xFF;
+        if (m != 0)
+            return i - 8 + 31 - __builtin_clz(m);
+    }
+#endif
+    return dpprofits_array_last_fit_scalar(v, i, c);
+}
+
+template <>
+inline Weight dpprofits_array_last_fit<int16_t>(const int16_t* v, Weight len, int16_t c)
+{
+    Weight i = len;
+#if defined(__AVX512BW__)
+    const __m512i cc = _mm512_set1_epi16(c);
+    for (; i >= 32; i -= 32) {
+        __mmask32 m = _mm512_cmple_epi16_mask(_mm512_loadu_si512((const void*)(v + i - 32)), cc);
+        if (m != 0)
+            return i - 32 + 31 - __builtin_clz(m);
+    }
+#elif defined(__AVX2__)
+    const __m256i cc = _mm256_set1_epi16(c);
+    for (; i >= 16; i -= 16) {
+        // Two bits per 16-bit lane.
+        __m256i gt = _mm256_cmpgt_epi16(_mm256_loadu_si256((const __m256i*)(v + i - 16)), cc);
+        unsigned m = ~(unsigned)_mm256_movemask_epi8(gt);
+        if (m != 0)
+            return i - 16 + (31 - __builtin_clz(m)) / 2;
+    }
+#endif
+    return dpprofits_array_last_fit_scalar(v, i, c);
+}
+
+inline int dp_value_size(Profit bound)
+{
+    if (bound <= INT16_MAX)
+        return 2;
+    if (bound <= INT32_MAX)
+        return 4;
+    return 8;
+}
+
+}
+
@@ -1,6 +1,11 @@
 #include "knapsacksolver/algorithms/dpprofits.hpp"
 
+#include "knapsacksolver/parallel.hpp"
 #include "knapsacksolver/algorithms/dembo.hpp"
+#include "knapsacksolver/algorithms/dpkernels.hpp"
+#include "knapsacksolver/algorithms/dpfile.hpp"
+
+#include <thread>
 
 #define INDEX(j,q) (j + 1) * (ub + 1) + (q)
 
@@ -8,9 +13,64 @@ using namespace knapsacksolver;
 
 /****************************** dpprofits_array *******************************/
 
-Output knapsacksolver::dpprofits_array(const Instance& instance, Info info)
+struct DpprofitsBounds
+{
+    Profit lb;
+    Profit ub;
+};
+
+/**
+ * Return the value of the greedy solution (or of the best single item if it
+ * is better) and the Dantzig upper bound, computed on a sorted copy of the
+ * item indices since the instance is not modified.
+ *
+ * The size of the profit DP tables is given by the upper bound. The Dantzig
+ * bound is at most twice the optimal value, whereas the bound of
+ * max_efficiency_item can be arbitrarily larger.
+ */
+DpprofitsBounds dpprofits_bounds(const Instance& instance, Info& info)
+{
+    std::vector<ItemPos> items;
+    for (ItemPos j = 0; j < instance.reduced_item_number(); ++j)
+        if (instance.item(j).w <= instance.capacity())
+            items.push_back(j);
+    std::sort(items.begin(), items.end(), [&instance](ItemPos j1, ItemPos j2)
+            {
+                return instance.item(j1).efficiency() > instance.item(j2).efficiency();
+            });
+
+    Profit p_max = 0;
+    Profit p = 0;
+    Weight r = instance.capacity();
+    Profit ub = -1;
+    for (ItemPos j: items) {
+        p_max = std::max(p_max, instance.item(j).p);
+        if (instance.item(j).w <= r) {
+            p += instance.item(j).p;
+            r -= instance.item(j).w;
+        } else if (ub == -1) {
+            ub = p + (r * instance.item(j).p) / instance.item(j).w;
+        }
+    }
+    if (ub == -1)
+        ub = p;
+    ItemPos j_max = instance.max_efficiency_item(info);
+    ub = std::min(ub, ub_0(instance, 0, 0, instance.capacity(), j_max));
+    return {std::max(p, p_max), ub};
+}
+
+/** Upper bound on the values of the profit DP tables.  */
+Weight dpprofits_array_value_bound(const Instance& instance)
+{
+    Weight w_max = 0;
+    for (ItemPos j = 0; j < instance.reduced_item_number(); ++j)
+        w_max = std::max(w_max, instance.item(j).w);
+    return instance.capacity() + 1 + w_max;
+}
+
+template <typename T>
+Output dpprofits_array_typed(const Instance& instance, Info& info)
 {
-    VER(info, "*** dpprofits (array) ***" << std::endl);
     Output output(instance, info);
 
     ItemIdx n = instance.reduced_item_number();
@@ -21,32 +81,36 @@ Output knapsacksolver::dpprofits_array(const Instance& instance, Info info)
 
     // Initialize memory table
     Weight c = instance.capacity();
-    ItemPos j_max = instance.max_efficiency_item(info);
-    Profit ub = ub_0(instance, 0, 0, instance.capacity(), j_max);
-    output.update_ub(ub, std::stringstream("initial upper bound"), info);
-    std::vector<Weight> values(ub + 1, c + 1);
+    // Profits are divided by their gcd g: cell q corresponds to profit q * g.
+    Profit g = std::max((Profit)1, instance.gcd_profits());
+    Profit ub = dpprofits_bounds(instance, info).ub / g;
+    output.update_ub(ub * g, std::stringstream("initial upper bound"), info);
+    std::vector<T> values(ub + 1, c + 1);
 
     // Compute optimal value
     values[0] = 0;
+    Profit q_lb = 0;
     for (ItemPos j = 0; j < n; ++j) {
         // Check time
         if (!info.check_time())
             return output.algorithm_end(info);
 
         // Update DP table
-        Profit pj = instance.item(j).p;
+        Profit pj = instance.item(j).p / g;
         Weight wj = instance.item(j).w;
-        for (Profit q = ub; q >= pj; --q) {
-            Weight w = (q == pj)? wj: values[q - pj] + wj;
-            if (values[q] > w) {
-                values[q] = w;
-                // Update lower bound
-                if (w <= c && output.lower_bound < q) {
-                    std::stringstream ss;
-                    ss << "it " << j;
-                    output.update_lb(q, ss, info);
-                }
-            }
+        if (pj <= ub)
+            dpprofits_array_update(
+                    values.data() + pj, values.data(), values.data() + pj,
+                    ub - pj + 1, (T)wj);
+
+        // Update lower bound
+        Profit q = q_lb + 1 + dpprofits_array_last_fit(
+                values.data() + q_lb + 1, ub - q_lb, (T)c);
+        if (q > q_lb) {
+            q_lb = q;
+            std::stringstream ss;
+            ss << "it " << j;
+            output.update_lb(q * g, ss, info);
         }
     }
 
@@ -56,11 +120,21 @@ Output knapsacksolver::dpprofits_array(const Instance& instance, Info info)
     return output.algorithm_end(info);
 }
 
+Output knapsacksolver::dpprofits_array(const Instance& instance, Info info)
+{
+    VER(info, "*** dpprofits (array) ***" << std::endl);
+    switch (dp_value_size(dpprofits_array_value_bound(instance))) {
+    case 2: return dpprofits_array_typed<int16_t>(instance, info);
+    case 4: return dpprofits_array_typed<int32_t>(instance, info);
+    default: return dpprofits_array_typed<int64_t>(instance, info);
+    }
+}
+
 /**************************** dpprofits_array_all *****************************/
 
-Output knapsacksolver::dpprofits_array_all(const Instance& instance, Info info)
+template <typename T>
+Output dpprofits_array_all_typed(const Instance& instance, Info& info)
 {
-    VER(info, "*** dpprofits (array, all) ***" << std::endl);
     Output output(instance, info);
 
     ItemIdx n = instance.reduced_item_number();
@@ -71,36 +145,42 @@ Output knapsacksolver::dpprofits_array_all(const Instance& instance, Info info)
 
     // Initialize memory table
     Weight c = instance.capacity();
-    ItemPos j_max = instance.max_efficiency_item(info);
-    Profit ub = ub_0(instance, 0, 0, instance.capacity(), j_max);
-    output.update_ub(ub, std::stringstream("initial upper bound"), info);
+    // Profits are divided by their gcd g: cell q corresponds to profit q * g.
+    Profit g = std::max((Profit)1, instance.gcd_profits());
+    Profit ub = dpprofits_bounds(instance, info).ub / g;
+    output.update_ub(ub * g, std::stringstream("initial upper bound"), info);
     StateIdx values_size = (n + 1) * (ub + 1);
-    std::vector<Weight> values(values_size);
+    std::vector<T> values(values_size);
 
     // Compute optimal value
     values[0] = 0;
     for (Profit q = 1; q <= ub; ++q)
         values[INDEX(-1, q)] = c + 1;
+    Profit q_lb = 0;
     for (ItemPos j = 0; j < n; ++j) {
-        Profit pj = instance.item(j).p;
-        Profit wj = instance.item(j).w;
-        for (Profit q = 0; q < pj; ++q)
-            values[INDEX(j, q)] = values[INDEX(j - 1, q)];
-        for (Profit q = pj; q <= ub; ++q) {
-            Weight v0 = values[INDEX(j - 1, q)];
-            Weight v1 = (q == pj)? wj: values[INDEX(j - 1, q - pj)] + wj;
-            values[INDEX(j, q)] = std::min(v1, v0);
-            if (v0 <= v1) {
-                values[INDEX(j, q)] = v0;
-            } else {
-                values[INDEX(j, q)] = v1;
-                // Update lower bound
-                if (v1 <= c && output.lower_bound < q) {
-                    std::stringstream ss;
-                    ss << "it " << j;
-                    output.update_lb(q, ss, info);
-                }
-            }
+        // Check time
+        if (!info.check_time())
+            return output.algorithm_end(info);
+
+        // Update DP table
+        Profit pj = instance.item(j).p / g;
+        Weight wj = instance.item(j).w;
+        const T* values_prev = values.data() + INDEX(j - 1, 0);
+        T* values_cur = values.data() + INDEX(j, 0);
+        std::copy(values_prev, values_prev + std::min(pj, ub + 1), values_cur);
+        if (pj <= ub)
+            dpprofits_array_update(
+                    values_prev + pj, values_prev, values_cur + pj,
+                    ub - pj + 1, (T)wj);
+
+        // Update lower bound
+        Profit q = q_lb + 1 + dpprofits_array_last_fit(
+                values_cur + q_lb + 1, ub - q_lb, (T)c);
+        if (q > q_lb) {
+            q_lb = q;
+            std::stringstream ss;
+            ss << "it " << j;
+            output.update_lb(q * g, ss, info);
         }
     }
 
@@ -108,15 +188,332 @@ Output knapsacksolver::dpprofits_array_all(const Instance& instance, Info info)
     output.update_ub(output.lower_bound, std::stringstream("tree search completed"), info);
 
     // Retrieve optimal solution
-    Weight q = output.lower_bound;
+    Weight q = output.lower_bound / g;
     Solution sol(instance);
     for (ItemPos j = n - 1; j >= 0; --j) {
         if (values[INDEX(j, q)] != values[INDEX(j - 1, q)]) {
-            q -= instance.item(j).p;
+            q -= instance.item(j).p / g;
+            sol.set(j, true);
+        }
+    }
+    output.update_sol(sol, std::stringstream(), info);
+
+    return output.algorithm_end(info);
+}
+
+Output knapsacksolver::dpprofits_array_all(const Instance& instance, Info info)
+{
+    VER(info, "*** dpprofits (array, all) ***" << std::endl);
+    switch (dp_value_size(dpprofits_array_value_bound(instance))) {
+    case 2: return dpprofits_array_all_typed<int16_t>(instance, info);
+    case 4: return dpprofits_array_all_typed<int32_t>(instance, info);
+    default: return dpprofits_array_all_typed<int64_t>(instance, info);
+    }
+}
+
+/**************************** dpprofits_array_file ****************************/
+
+/**
+ * Forward pass and retrieval of the solution of dpprofits_array_file. Bit q
+ * of row j is set iff the value of cell q changes with item j, i.e. iff item
+ * j is taken in the best solution of profit q * g. The rows are either a
+ * DpRowFile or a DpRowMemory. Return false if they could not be written.
+ */
+template <typename T, typename Rows>
+bool dpprofits_array_rows(const Instance& instance,
+        Profit g, Profit ub, Rows& rows, Output& output, Info& info)
+{
+    ItemIdx n = instance.reduced_item_number();
+    Weight c = instance.capacity();
+    StateIdx word_number = ub / 64 + 1;
+    std::vector<uint64_t> taken(word_number);
+    std::vector<T> values(ub + 1, c + 1);
+    values[0] = 0;
+
+    // Compute optimal value
+    Profit q_lb = 0;
+    for (ItemPos j = 0; j < n; ++j) {
+        // Check time
+        if (!info.check_time())
+            return true;
+
+        // Update DP table
+        Profit pj = instance.item(j).p / g;
+        Weight wj = instance.item(j).w;
+        std::fill(taken.begin(), taken.end(), 0);
+        if (pj <= ub)
+            dpprofits_array_update_bits(
+                    &values[pj], &values[0], &values[pj], ub - pj + 1, (T)wj,
+                    taken.data(), pj);
+        rows.append(taken.data());
+
+        // Update lower bound
+        Profit q = q_lb + 1 + dpprofits_array_last_fit(
+                values.data() + q_lb + 1, ub - q_lb, (T)c);
+        if (q > q_lb) {
+            q_lb = q;
+            std::stringstream ss;
+            ss << "it " << j;
+            output.update_lb(q * g, ss, info);
+        }
+    }
+    rows.finish();
+    if (!rows.ok())
+        return false;
+
+    // Update upper bound
+    output.update_ub(output.lower_bound, std::stringstream("tree search completed"), info);
+
+    // Retrieve optimal solution
+    Profit q = output.lower_bound / g;
+    Solution sol(instance);
+    for (ItemPos j = n - 1; j >= 0; --j) {
+        // The word of row j - 1 which will be read is one of two words.
+        Profit pj = instance.item(j).p / g;
+        if (j > 0) {
+            rows.prefetch(j - 1, q / 64 * sizeof(uint64_t), sizeof(uint64_t));
+            if (q >= pj)
+                rows.prefetch(j - 1, (q - pj) / 64 * sizeof(uint64_t), sizeof(uint64_t));
+        }
+        const uint64_t* row = (const uint64_t*)rows.row(j);
+        if ((row[q / 64] >> (q % 64)) & 1) {
+            q -= pj;
             sol.set(j, true);
         }
     }
     output.update_sol(sol, std::stringstream(), info);
+    return true;
+}
+
+/**
+ * If in_memory is true, the decision bits are kept in memory, and they are
+ * only written to the scratch file if they don't fit.
+ */
+template <typename T>
+Output dpprofits_array_file_typed(const Instance& instance,
+        std::string scratch_directory, bool in_memory, Info& info)
+{
+    Output output(instance, info);
+
+    ItemIdx n = instance.reduced_item_number();
+    if (n == 0) {
+        output.update_ub(0, std::stringstream("no item"), info);
+        return output.algorithm_end(info);
+    }
+
+    Profit g = std::max((Profit)1, instance.gcd_profits());
+    Profit ub = dpprofits_bounds(instance, info).ub / g;
+    output.update_ub(ub * g, std::stringstream("initial upper bound"), info);
+    StateIdx row_size = (ub / 64 + 1) * sizeof(uint64_t);
+
+    if (in_memory) {
+        DpRowMemory rows(row_size, n);
+        if (rows.ok()) {
+            dpprofits_array_rows<T>(instance, g, ub, rows, output, info);
+            return output.algorithm_end(info);
+        }
+        VER(info, "Cannot allocate the DP table, it is written to a scratch file." << std::endl);
+    }
+
+    DpRowFile file(scratch_directory, row_size, n);
+    if (!file.ok()) {
+        VER(info, "Cannot create the scratch file, the DP table is kept in memory." << std::endl);
+        return dpprofits_array_all_typed<T>(instance, info);
+    }
+    if (!dpprofits_array_rows<T>(instance, g, ub, file, output, info)) {
+        VER(info, "Cannot write the scratch file, the DP table is kept in memory." << std::endl);
+        return dpprofits_array_all_typed<T>(instance, info);
+    }
+    return output.algorithm_end(info);
+}
+
+Output knapsacksolver::dpprofits_array_file(const Instance& instance,
+        std::string scratch_directory, Info info)
+{
+    VER(info, "*** dpprofits (array, file) ***" << std::endl);
+    switch (dp_value_size(dpprofits_array_value_bound(instance))) {
+    case 2: return dpprofits_array_file_typed<int16_t>(instance, scratch_directory, false, info);
+    case 4: return dpprofits_array_file_typed<int32_t>(instance, scratch_directory, false, info);
+    default: return dpprofits_array_file_typed<int64_t>(instance, scratch_directory, false, info);
+    }
+}
+
+/**
+ * Same as dpprofits_array_file, but the decision bits are kept in memory when
+ * they fit.
+ */
+Output dpprofits_array_bits(const Instance& instance, Info info)
+{
+    switch (dp_value_size(dpprofits_array_value_bound(instance))) {
+    case 2: return dpprofits_array_file_typed<int16_t>(instance, "", true, info);
+    case 4: return dpprofits_array_file_typed<int32_t>(instance, "", true, info);
+    default: return dpprofits_array_file_typed<int64_t>(instance, "", true, info);
+    }
+}
+
+/***************************** dpprofitspar_array *****************************/
+
+template <typename T>
+struct DpprofitsparArrayData
+{
+    const Instance& instance;
+    Profit g;
+    std::vector<T>& values_1;
+    std::vector<T>& values_2;
+    /** Largest profit reached by a solution in the range of each thread. */
+    std::vector<Profit>& q_fit;
+    Barrier& barrier;
+    bool& end;
+};
+
+template <typename T>
+void dpprofitspar_array_worker(
+        DpprofitsparArrayData<T> d, Counter thread_id, Profit q_first, Profit q_last)
+{
+    Weight c = d.instance.capacity();
+    for (ItemPos j = 0; j < d.instance.reduced_item_number() && !d.end; ++j) {
+        // Item j reads values_1 and writes values_2 if j is even, and the
+        // opposite otherwise.
+        const T* values_src = ((j % 2 == 0)? d.values_1: d.values_2).data();
+        T* values_dst = ((j % 2 == 0)? d.values_2: d.values_1).data();
+        Profit pj = d.instance.item(j).p / d.g;
+        Weight wj = d.instance.item(j).w;
+        Profit q = std::max(q_first, std::min(pj, q_last + 1));
+        std::copy(values_src + q_first, values_src + q, values_dst + q_first);
+        if (q <= q_last)
+            dpprofits_array_update(
+                    values_src + q,
+                    values_src + q - pj,
+                    values_dst + q,
+                    q_last - q + 1, (T)wj);
+        Weight i = dpprofits_array_last_fit(
+                values_dst + q_first, q_last - q_first + 1, (T)c);
+        d.q_fit[thread_id] = (i == -1)? -1: q_first + i;
+        d.barrier.arrive_and_wait();
+    }
+}
+
+template <typename T>
+Output dpprofitspar_array_typed(
+        const Instance& instance, Counter thread_number, Info& info)
+{
+    Output output(instance, info);
+
+    ItemIdx n = instance.reduced_item_number();
+    if (n == 0) {
+        output.update_ub(0, std::stringstream("no item"), info);
+        return output.algorithm_end(info);
+    }
+
+    Weight c = instance.capacity();
+    Profit g = std::max((Profit)1, instance.gcd_profits());
+    Profit ub = dpprofits_bounds(instance, info).ub / g;
+    output.update_ub(ub * g, std::stringstream("initial upper bound"), info);
+    thread_number = std::max((Counter)1, std::min(thread_number, ub + 1));
+
+    // Each item is processed by all threads, each one on its own range of
+    // profits. Since values[q - pj] may belong to the range of another
+    // thread, the values of item j are written in a second array. The
+    // threads are synchronized after each item, and the lower bound is the
+    // largest of the profits found by the threads in their range.
+    std::vector<T> values_1(ub + 1, c + 1);
+    std::vector<T> values_2(ub + 1, c + 1);
+    values_1[0] = 0;
+    std::vector<Profit> q_fit(thread_number, -1);
+    ItemPos j = 0;
+    bool end = false;
+    Barrier barrier(thread_number, [&]()
+            {
+                // Update lower bound
+                Profit q = *std::max_element(q_fit.begin(), q_fit.end());
+                if (output.lower_bound < q * g) {
+                    std::stringstream ss;
+                    ss << "it " << j;
+                    output.update_lb(q * g, ss, info);
+                }
+                j++;
+
+                // Check time
+                if (j < n && !info.check_time())
+                    end = true;
+            });
+    DpprofitsparArrayData<T> d {
+        .instance = instance,
+        .g        = g,
+        .values_1 = values_1,
+        .values_2 = values_2,
+        .q_fit    = q_fit,
+        .barrier  = barrier,
+        .end      = end};
+
+    Profit block_size = (ub + thread_number) / thread_number;
+    std::vector<std::thread> threads;
+    for (Counter thread_id = 1; thread_id < thread_number; ++thread_id)
+        threads.push_back(std::thread(dpprofitspar_array_worker<T>, d, thread_id,
+                    std::min(ub + 1, thread_id * block_size),
+                    std::min(ub, (thread_id + 1) * block_size - 1)));
+    dpprofitspar_array_worker<T>(d, 0, 0, std::min(ub, block_size - 1));
+    for (std::thread& thread: threads)
+        thread.join();
+    if (end)
+        return output.algorithm_end(info);
+
+    // Update upper bound
+    output.update_ub(output.lower_bound, std::stringstream("tree search completed"), info);
+
+    return output.algorithm_end(info);
+}
+
+Output knapsacksolver::dpprofitspar_array(
+        const Instance& instance, Counter thread_number, Info info)
+{
+    VER(info, "*** dpprofitspar (array, " << thread_number << " threads) ***" << std::endl);
+    switch (dp_value_size(dpprofits_array_value_bound(instance))) {
+    case 2: return dpprofitspar_array_typed<int16_t>(instance, thread_number, info);
+    case 4: return dpprofitspar_array_typed<int32_t>(instance, thread_number, info);
+    default: return dpprofitspar_array_typed<int64_t>(instance, thread_number, info);
+    }
+}
+
+/*********************************** fptas ************************************/
+
+Output knapsacksolver::fptas(const Instance& instance, double epsilon, Info info)
+{
+    VER(info, "*** fptas (epsilon " << epsilon << ") ***" << std::endl);
+    Output output(instance, info);
+
+    ItemIdx n = instance.item_number();
+    if (n == 0) {
+        output.update_ub(0, std::stringstream("no item"), info);
+        return output.algorithm_end(info);
+    }
+
+    // Each item of the optimal solution loses at most K - 1 when its profit is
+    // rounded down, therefore the loss is less than n * K <= epsilon * LB.
+    Profit lb = dpprofits_bounds(instance, info).lb;
+    Profit k = std::max((Profit)1, (Profit)(epsilon * lb / n));
+    VER(info, "Scaling factor: " << k << std::endl);
+
+    // Only one bit per cell is stored, so that small values of epsilon, for
+    // which K = 1, remain tractable.
+    Instance instance_scaled;
+    for (ItemPos j = 0; j < n; ++j)
+        instance_scaled.add_item(instance.item(j).w, instance.item(j).p / k);
+    instance_scaled.set_capacity(instance.capacity());
+    Output output_scaled = dpprofits_array_bits(instance_scaled, Info(info, false, ""));
+    if (!info.check_time())
+        return output.algorithm_end(info);
+
+    // Retrieve the solution in the original instance
+    Solution sol(instance);
+    for (ItemPos j = 0; j < n; ++j)
+        if (output_scaled.solution.contains(j))
+            sol.set(j, true);
+    output.update_sol(sol, std::stringstream("scaled solution"), info);
+
+    // Update upper bound
+    Profit ub = k * output_scaled.upper_bound + n * (k - 1);
+    output.update_ub(std::max(ub, output.lower_bound), std::stringstream("scaled upper bound"), info);
 
     return output.algorithm_end(info);
 }
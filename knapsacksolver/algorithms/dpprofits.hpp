@@ -7,6 +7,27 @@ namespace knapsacksolver
 
 Output dpprofits_array(const Instance& instance, Info info = Info());
 Output dpprofits_array_all(const Instance& instance, Info info = Info());
+/**
+ * Same as dpprofits_array_all, but only one bit per cell is stored, in a
+ * scratch file in scratch_directory ($TMPDIR or /tmp if empty). If the
+ * scratch file cannot be created or written, falls back to
+ * dpprofits_array_all.
+ */
+Output dpprofits_array_file(const Instance& instance, std::string scratch_directory = "", Info info = Info());
+Output dpprofitspar_array(const Instance& instance, Counter thread_number = 2, Info info = Info());
+
+/**
+ * Fully polynomial time approximation scheme.
+ *
+ * Profits are divided by K = floor(epsilon * LB / n) where LB is a lower bound
+ * of the optimal value, and the scaled instance is solved exactly. Only one
+ * bit per cell of the DP table is kept, in memory, or in a scratch file if it
+ * doesn't fit. The solution returned has a value of at least
+ * (1 - epsilon) times the optimal value, and the upper bound returned is
+ * valid. See "Fast Approximation Algorithms for the Knapsack and Sum of
+ * Subset Problems" (Ibarra and Kim, 1975).
+ */
+Output fptas(const Instance& instance, double epsilon = 0.001, Info info = Info());
 
 }
 
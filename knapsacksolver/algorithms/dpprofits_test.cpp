@@ -7,19 +7,35 @@ using namespace knapsacksolver;
 Output bellman_array_test(Instance& ins)       { return bellman_array(ins); }
 Output dpprofits_array_test(Instance& ins)     { return dpprofits_array(ins); }
 Output dpprofits_array_all_test(Instance& ins) { return dpprofits_array_all(ins); }
+Output dpprofits_array_file_test(Instance& ins) { return dpprofits_array_file(ins); }
+Output dpprofits_array_file_nodir_test(Instance& ins) { return dpprofits_array_file(ins, "/knapsacksolver_nonexistent"); }
+Output dpprofitspar_array_test(Instance& ins)  { return dpprofitspar_array(ins, 3); }
+Output fptas_test(Instance& ins)               { return fptas(ins, 0.1); }
+Output fptas_exact_test(Instance& ins)         { return fptas(ins, 1e-9); }
 
 std::vector<Output (*)(Instance&)> f_opt {
         bellman_array_test,
         dpprofits_array_test,
+        dpprofitspar_array_test,
 };
 
 std::vector<Output (*)(Instance&)> f_sopt {
         bellman_array_test,
         dpprofits_array_all_test,
+        dpprofits_array_file_test,
+        dpprofits_array_file_nodir_test,
+        fptas_exact_test,
+};
+
+std::vector<Output (*)(Instance&)> f_lb {
+        bellman_array_test,
+        fptas_test,
 };
 
 TEST(dpprofits, TEST_SOPT)  { test(TEST, f_sopt, SOPT); }
 TEST(dpprofits, SMALL_SOPT) { test(SMALL, f_sopt, SOPT); }
 TEST(dpprofits, TEST_OPT)  { test(TEST, f_opt, OPT); }
 TEST(dpprofits, SMALL_OPT) { test(SMALL, f_opt, OPT); }
+TEST(dpprofits, SMALL_LB)  { test(SMALL, f_lb, LB); }
+TEST(dpprofits, SMALL_UB)  { test(SMALL, f_lb, UB); }
 
@@ -1,27 +1,94 @@
 #include "knapsacksolver/algorithms/expknap.hpp"
 
+#include "knapsacksolver/parallel.hpp"
 #include "knapsacksolver/algorithms/greedy.hpp"
 #include "knapsacksolver/algorithms/greedynlogn.hpp"
 #include "knapsacksolver/algorithms/dembo.hpp"
 #include "knapsacksolver/algorithms/dantzig.hpp"
 #include "knapsacksolver/algorithms/surrelax.hpp"
 
+#include <algorithm>
+
 using namespace knapsacksolver;
 
+/**
+ * Node of the iterative tree search.
+ *
+ * Its partial solution has profit p and remaining capacity r. If r >= 0, its
+ * next child adds item t, otherwise it removes item s.
+ */
+struct ExpknapNode
+{
+    ItemPos s;
+    ItemPos t;
+    Profit p;
+    Weight r;
+};
+
+/**
+ * Node of the pool of the best-first search. Its partial solution is the one
+ * of node "parent" with item j added if j is after the break item, removed
+ * otherwise.
+ */
+struct ExpknapPoolNode
+{
+    StateIdx parent;
+    ItemPos j;
+};
+
+/**
+ * Node of the priority queue of the best-first search.
+ */
+struct ExpknapQueueNode
+{
+    Profit ub;
+    ExpknapNode node;
+    /** Node of the pool of its partial solution, -1 for the root.  */
+    StateIdx pool;
+};
+
 struct ExpknapInternalData
 {
     ExpknapInternalData(Instance& instance, ExpknapOptionalParameters& p, ExpknapOutput& output):
-        instance(instance), p(p), output(output), sol_curr(*instance.break_solution()) { }
+        instance(instance), p(p), output(output),
+        lb(output.solution.profit()), node_number(0) { }
     Instance& instance;
     ExpknapOptionalParameters& p;
     ExpknapOutput& output;
-    Solution sol_curr;
+    /** Threads of the tree search, NULL if thread_number == 1.  */
+    ThreadPool* thread_pool = NULL;
+    /**
+     * Profit of the best solution, shared by the threads of the tree search,
+     * so that a solution found by one of them prunes the others at once.
+     */
+    std::atomic<Profit> lb;
+    /** Nodes explored, without the ones not yet reported by the threads.  */
+    std::atomic<Counter> node_number;
     std::vector<std::thread> threads;
+    /** Nodes of the branch of the depth-first search.  */
+    std::vector<ExpknapNode> stack;
+    /** Partial solutions of the nodes of the best-first search.  */
+    std::vector<ExpknapPoolNode> pool;
+    /** Nodes of the best-first search not explored yet, as a heap.  */
+    std::vector<ExpknapQueueNode> queue;
+};
+
+/**
+ * Data of a thread of the tree search.
+ */
+struct ExpknapThreadData
+{
+    Solution sol_curr;
+    /** Nodes explored and not yet added to d.node_number.  */
+    Counter node_number;
+    /** Only the thread which started the search starts the other algorithms. */
+    bool main;
 };
 
 void expknap_update_bounds(ExpknapInternalData& d)
 {
-    if (d.p.surrelax >= 0 && d.p.surrelax <= d.output.node_number) {
+    Counter node_number = d.node_number.load(std::memory_order_relaxed);
+    if (d.p.surrelax >= 0 && d.p.surrelax <= node_number) {
         d.p.surrelax = -1;
         std::function<Output (Instance&, Info, bool*)> func
             = [&d](Instance& ins, Info info, bool* end)
@@ -44,20 +111,75 @@ void expknap_update_bounds(ExpknapInternalData& d)
                     .end      = d.p.end,
                     .info     = Info(d.p.info, true, "surrelax")}));
     }
-    if (d.p.greedynlogn >= 0 && d.p.greedynlogn <= d.output.node_number) {
+    if (d.p.greedynlogn >= 0 && d.p.greedynlogn <= node_number) {
         d.p.greedynlogn = -1;
         auto gn_output = greedynlogn(d.instance);
         d.output.update_sol(gn_output.solution, std::stringstream("greedynlogn"), d.p.info);
     }
+    // The solutions found by the other algorithms prune the tree search too.
+    Profit lb = d.lb.load();
+    Profit lb_output;
+    {
+        // output.solution is written by Output::update_sol under this mutex.
+        std::lock_guard<std::mutex> lock(d.p.info.output->mutex_sol);
+        lb_output = d.output.solution.profit();
+    }
+    while (lb < lb_output && !d.lb.compare_exchange_weak(lb, lb_output));
 }
 
-void expknap_rec(ExpknapInternalData& d, ItemPos s, ItemPos t)
+/**
+ * Update the best solution with sol if it is better.
+ */
+void expknap_update_sol(ExpknapInternalData& d, const Solution& sol)
+{
+    Profit lb = d.lb.load();
+    while (lb < sol.profit()) {
+        if (d.lb.compare_exchange_weak(lb, sol.profit())) {
+            std::stringstream ss;
+            ss << "node " << d.node_number.load(std::memory_order_relaxed);
+            d.output.update_sol(sol, ss, d.p.info);
+            return;
+        }
+    }
+}
+
+void expknap_rec(ExpknapInternalData& d, ExpknapThreadData& td,
+        ItemPos s, ItemPos t, ItemPos depth);
+
+/**
+ * Give the subtree of the current solution of td with item j set to value to
+ * a thread of the pool if the node is close enough to the root and if a
+ * thread is waiting. Return false if it has been given to the pool.
+ */
+bool expknap_fork(ExpknapInternalData& d, ExpknapThreadData& td,
+        ItemPos s, ItemPos t, ItemPos depth, ItemPos j, int value)
+{
+    if (d.thread_pool == NULL
+            || depth >= d.p.parallel_depth
+            || !d.thread_pool->idle())
+        return true;
+    ExpknapThreadData td_new {td.sol_curr, 0, false};
+    td_new.sol_curr.set(j, value);
+    return !d.thread_pool->try_push([&d, td_new, s, t, depth]() mutable
+            {
+                expknap_rec(d, td_new, s, t, depth + 1);
+                d.node_number += td_new.node_number;
+            });
+}
+
+void expknap_rec(ExpknapInternalData& d, ExpknapThreadData& td,
+        ItemPos s, ItemPos t, ItemPos depth)
 {
     Info& info = d.p.info;
-    d.output.node_number++; // Increment node number
-    LOG_FOLD_START(info, "node number " << d.output.node_number
+    Solution& sol_curr = td.sol_curr;
+    // Increment node number
+    if (++td.node_number == 1024) {
+        d.node_number += td.node_number;
+        td.node_number = 0;
+    }
+    LOG_FOLD_START(info, "node number " << d.node_number
             << " s " << s << " t " << t
-            << " w " << d.sol_curr.weight() << " p " << d.sol_curr.profit()
+            << " w " << sol_curr.weight() << " p " << sol_curr.profit()
             << std::endl);
 
     // Check end
@@ -70,35 +192,31 @@ void expknap_rec(ExpknapInternalData& d, ItemPos s, ItemPos t)
     if (!info.check_time()) {
         if (d.p.set_end)
             *(d.p.end) = true;
-        for (std::thread& thread: d.threads)
-            thread.join();
-        d.threads.clear();
         LOG_FOLD_END(info, "time");
         return;
     }
 
     // If UB reached, then stop
-    if (d.output.solution.profit() == d.output.upper_bound) {
+    if (d.lb.load(std::memory_order_relaxed) == d.output.upper_bound) {
         LOG_FOLD_END(info, "lb == ub");
         return;
     }
 
-    // Update bounds
-    expknap_update_bounds(d);
+    // Update bounds, when the node number has been reported
+    if (td.main && td.node_number == 0)
+        expknap_update_bounds(d);
 
-    if (d.sol_curr.remaining_capacity() >= 0) {
+    if (sol_curr.remaining_capacity() >= 0) {
         // Update best solution
-        if (d.output.solution.profit() < d.sol_curr.profit()) {
-            std::stringstream ss;
-            ss << "node " << d.output.node_number;
-            d.output.update_sol(d.sol_curr, ss, info);
-        }
+        if (d.lb.load(std::memory_order_relaxed) < sol_curr.profit())
+            expknap_update_sol(d, sol_curr);
 
         for (;;t++) {
             // Bounding test
-            Profit ub = ub_dembo(d.instance, d.instance.bound_item_right(t, d.output.solution.profit(), info), d.sol_curr);
-            LOG(info, "t " << t << " ub " << ub << " lb " << d.output.solution.profit());
-            if (ub <= d.output.solution.profit()) {
+            Profit lb = d.lb.load(std::memory_order_relaxed);
+            Profit ub = ub_dembo(d.instance, d.instance.bound_item_right(t, lb, info), sol_curr);
+            LOG(info, "t " << t << " ub " << ub << " lb " << lb);
+            if (ub <= lb) {
                 LOG_FOLD_END(info, " bound");
                 return;
             }
@@ -106,16 +224,19 @@ void expknap_rec(ExpknapInternalData& d, ItemPos s, ItemPos t)
             // Recursive call
             assert(t <= d.instance.last_item());
             LOG(info, " add (" << d.instance.item(t) << ")" << std::endl);
-            d.sol_curr.set(t, true); // Add item t
-            expknap_rec(d, s, t + 1);
-            d.sol_curr.set(t, false); // Remove item t
+            if (expknap_fork(d, td, s, t + 1, depth, t, true)) {
+                sol_curr.set(t, true); // Add item t
+                expknap_rec(d, td, s, t + 1, depth + 1);
+                sol_curr.set(t, false); // Remove item t
+            }
         }
     } else {
         for (;;s--) {
             // Bounding test
-            Profit ub = ub_dembo_rev(d.instance, d.instance.bound_item_left(s, d.output.solution.profit(), info), d.sol_curr);
-            LOG(info, "s " << s << " ub " << ub << " lb " << d.output.solution.profit());
-            if (ub <= d.output.solution.profit()) {
+            Profit lb = d.lb.load(std::memory_order_relaxed);
+            Profit ub = ub_dembo_rev(d.instance, d.instance.bound_item_left(s, lb, info), sol_curr);
+            LOG(info, "s " << s << " ub " << ub << " lb " << lb);
+            if (ub <= lb) {
                 LOG_FOLD_END(info, " bound");
                 return;
             }
@@ -123,17 +244,215 @@ void expknap_rec(ExpknapInternalData& d, ItemPos s, ItemPos t)
             // Recursive call
             assert(s >= d.instance.first_item());
             LOG(info, " remove (" << d.instance.item(s) << ")" << std::endl);
-            d.sol_curr.set(s, false); // Remove item s
-            expknap_rec(d, s - 1, t);
-            d.sol_curr.set(s, true); // Add item s
+            if (expknap_fork(d, td, s - 1, t, depth, s, false)) {
+                sol_curr.set(s, false); // Remove item s
+                expknap_rec(d, td, s - 1, t, depth + 1);
+                sol_curr.set(s, true); // Add item s
+            }
         }
     }
     assert(false);
 }
 
+/**
+ * Count a new node, and every 1024 nodes, check the time and update the
+ * bounds. Return false if the search must stop.
+ */
+bool expknap_check(ExpknapInternalData& d, ExpknapThreadData& td)
+{
+    Info& info = d.p.info;
+    // Increment node number. The time and the bounds are only checked when
+    // the node number is reported, so that the clock is not read and the
+    // output mutex is not locked on every node.
+    if (++td.node_number == 1024) {
+        d.node_number += td.node_number;
+        td.node_number = 0;
+
+        // Check time
+        if (!info.check_time()) {
+            if (d.p.set_end)
+                *(d.p.end) = true;
+            return false;
+        }
+
+        // Update bounds
+        expknap_update_bounds(d);
+    }
+
+    // Check end
+    if (d.p.stop_if_end && *(d.p.end))
+        return false;
+
+    // If UB reached, then stop
+    if (d.lb.load(std::memory_order_relaxed) == d.output.upper_bound)
+        return false;
+
+    return true;
+}
+
+/**
+ * Return the upper bound of the subtree of node.
+ */
+Profit expknap_bound(ExpknapInternalData& d, const ExpknapNode& node)
+{
+    Profit lb = d.lb.load(std::memory_order_relaxed);
+    if (node.r >= 0) {
+        ItemPos t = d.instance.bound_item_right(node.t, lb, d.p.info);
+        return ub_dembo(d.instance, t, node.p, node.r);
+    } else {
+        ItemPos s = d.instance.bound_item_left(node.s, lb, d.p.info);
+        return ub_dembo_rev(d.instance, s, node.p, node.r);
+    }
+}
+
+/**
+ * Return the next child of node, and replace node by the node whose children
+ * are its remaining children.
+ */
+ExpknapNode expknap_branch(const Instance& instance, ExpknapNode& node)
+{
+    if (node.r >= 0) {
+        assert(node.t <= instance.last_item());
+        const Item& item = instance.item(node.t);
+        node.t++;
+        return {node.s, node.t, node.p + item.p, node.r - item.w};
+    } else {
+        assert(node.s >= instance.first_item());
+        const Item& item = instance.item(node.s);
+        node.s--;
+        return {node.s, node.t, node.p - item.p, node.r + item.w};
+    }
+}
+
+/**
+ * Explore the subtree of root depth-first, with d.stack instead of recursive
+ * calls. td.sol_curr is the partial solution of root; the ones of the other
+ * nodes are only built when they improve the best solution.
+ *
+ * Return false if the search must stop.
+ */
+bool expknap_dfs(ExpknapInternalData& d, ExpknapThreadData& td,
+        const ExpknapNode& root)
+{
+    std::vector<ExpknapNode>& stack = d.stack;
+    stack.clear();
+    stack.push_back(root);
+    while (!stack.empty()) {
+        // Bounding test
+        if (expknap_bound(d, stack.back()) <= d.lb.load(std::memory_order_relaxed)) {
+            stack.pop_back();
+            continue;
+        }
+
+        // The items of the children of a node are after its own item, so the
+        // stack never holds more than item_number + 1 nodes.
+        ExpknapNode node = expknap_branch(d.instance, stack.back());
+        stack.push_back(node);
+        if (!expknap_check(d, td))
+            return false;
+
+        // Update best solution
+        if (node.r >= 0 && d.lb.load(std::memory_order_relaxed) < node.p) {
+            // Each node of the branch has been modified by expknap_branch
+            // once since its child in the branch was created.
+            Solution sol(td.sol_curr);
+            for (StateIdx i = 0; i < (StateIdx)stack.size() - 1; ++i) {
+                if (stack[i].r >= 0) {
+                    sol.set(stack[i].t - 1, true);
+                } else {
+                    sol.set(stack[i].s + 1, false);
+                }
+            }
+            assert(sol.profit() == node.p);
+            expknap_update_sol(d, sol);
+        }
+    }
+    return true;
+}
+
+/**
+ * Return the partial solution of node i of the pool, where sol_root is the
+ * partial solution of the root of the best-first search.
+ */
+Solution expknap_pool_solution(const ExpknapInternalData& d,
+        const Solution& sol_root, StateIdx i)
+{
+    Solution sol(sol_root);
+    ItemPos b = d.instance.break_item();
+    for (; i != -1; i = d.pool[i].parent)
+        sol.set(d.pool[i].j, d.pool[i].j >= b);
+    return sol;
+}
+
+bool expknap_queue_less(const ExpknapQueueNode& n1, const ExpknapQueueNode& n2)
+{
+    return n1.ub < n2.ub;
+}
+
+/**
+ * Explore the subtree of root in decreasing order of upper bound.
+ * td.sol_curr is the partial solution of root. Once the pool is full, the
+ * subtrees of the nodes of the queue are explored depth-first, still in
+ * decreasing order of upper bound.
+ *
+ * Return false if the search must stop.
+ */
+bool expknap_best_first(ExpknapInternalData& d, ExpknapThreadData& td,
+        const ExpknapNode& root)
+{
+    Solution sol_root(td.sol_curr);
+    d.pool.clear();
+    d.queue.clear();
+    d.queue.push_back({expknap_bound(d, root), root, -1});
+    while (!d.queue.empty()) {
+        std::pop_heap(d.queue.begin(), d.queue.end(), expknap_queue_less);
+        ExpknapQueueNode q = d.queue.back();
+        d.queue.pop_back();
+        if (q.ub <= d.lb.load(std::memory_order_relaxed))
+            break;
+
+        // The subtrees of the nodes of the queue contain all the solutions
+        // not explored yet, so their largest upper bound is an upper bound.
+        Profit ub = std::max(q.ub, d.lb.load());
+        d.output.update_ub(ub, std::stringstream("best-first search (ub)"), d.p.info);
+
+        if ((StateIdx)d.pool.size() >= d.p.best_first_node_number_max) {
+            td.sol_curr = expknap_pool_solution(d, sol_root, q.pool);
+            if (!expknap_dfs(d, td, q.node))
+                return false;
+            continue;
+        }
+
+        ExpknapNode node = expknap_branch(d.instance, q.node);
+        ItemPos j = (q.node.r >= 0)? q.node.t - 1: q.node.s + 1;
+        d.pool.push_back({q.pool, j});
+        StateIdx i = d.pool.size() - 1;
+        if (!expknap_check(d, td))
+            return false;
+
+        // Update best solution
+        if (node.r >= 0 && d.lb.load(std::memory_order_relaxed) < node.p)
+            expknap_update_sol(d, expknap_pool_solution(d, sol_root, i));
+
+        // Add the child and the remaining children of q to the queue.
+        for (const ExpknapQueueNode& q_new: {
+                ExpknapQueueNode{0, node, i},
+                ExpknapQueueNode{0, q.node, q.pool}}) {
+            Profit ub = expknap_bound(d, q_new.node);
+            if (ub <= d.lb.load(std::memory_order_relaxed))
+                continue;
+            d.queue.push_back({ub, q_new.node, q_new.pool});
+            std::push_heap(d.queue.begin(), d.queue.end(), expknap_queue_less);
+        }
+    }
+    return true;
+}
+
 ExpknapOutput knapsacksolver::expknap(Instance& instance, ExpknapOptionalParameters p)
 {
     VER(p.info, "*** expknap"
+            << " -t " << p.thread_number
+            << ((p.best_first)? " -b": "")
             << ((p.greedy)? " -g": "")
             << " -s " << p.surrelax
             << " -n " << p.greedynlogn
@@ -141,6 +460,8 @@ ExpknapOutput knapsacksolver::expknap(Instance& instance, ExpknapOptionalParamet
             << " ***" << std::endl);
 
     LOG_FOLD_START(p.info, "*** expknap"
+            << " -t " << p.thread_number
+            << ((p.best_first)? " -b": "")
             << ((p.greedy)? " -g": "")
             << " -s " << p.surrelax
             << " -n " << p.greedynlogn
@@ -188,9 +509,38 @@ ExpknapOutput knapsacksolver::expknap(Instance& instance, ExpknapOptionalParamet
     if (output.solution.profit() == output.upper_bound)
         return output.algorithm_end(p.info);
 
+    // The other threads of the tree search only read the instance, so the
+    // items are sorted and reduced beforehand instead of on the fly.
+    if (p.thread_number > 1) {
+        instance.bound_item_left(instance.first_item() - 1, output.lower_bound, p.info);
+        instance.bound_item_right(instance.last_item() + 1, output.lower_bound, p.info);
+    }
+
     ExpknapInternalData d(instance, p, output);
     ItemPos b = instance.break_item();
-    expknap_rec(d, b - 1, b);
+    ExpknapThreadData td {*instance.break_solution(), 0, true};
+    if (p.thread_number > 1) {
+        ThreadPool thread_pool(p.thread_number);
+        d.thread_pool = &thread_pool;
+        expknap_rec(d, td, b - 1, b, 0);
+        thread_pool.wait();
+        d.thread_pool = NULL;
+    } else {
+        ExpknapNode root {b - 1, b,
+            td.sol_curr.profit(), td.sol_curr.remaining_capacity()};
+        d.stack.reserve(instance.item_number() + 1);
+        if (expknap_check(d, td)) {
+            if (d.lb.load() < root.p)
+                expknap_update_sol(d, td.sol_curr);
+            if (p.best_first) {
+                expknap_best_first(d, td, root);
+            } else {
+                expknap_dfs(d, td, root);
+            }
+        }
+    }
+    d.node_number += td.node_number;
+    output.node_number = d.node_number;
     if (p.info.check_time())
         output.update_ub(output.lower_bound, std::stringstream("tree search completed (ub)"), p.info);
 
@@ -16,6 +16,19 @@ struct ExpknapOptionalParameters
     StateIdx surrelax = -1;
     bool combo_core = false;
 
+    // The tree search is run by "thread_number" threads. The subtrees of the
+    // nodes of depth smaller than "parallel_depth" are given to the threads
+    // waiting for work.
+    Counter thread_number = 1;
+    ItemPos parallel_depth = 16;
+
+    // If "best_first" == true and "thread_number" == 1, the nodes are
+    // explored in decreasing order of upper bound, which makes the upper bound
+    // decrease faster, until "best_first_node_number_max" nodes are stored.
+    // The subtrees of the remaining nodes are then explored depth-first.
+    bool best_first = false;
+    StateIdx best_first_node_number_max = 1 << 20;
+
     bool* end = NULL;
     bool stop_if_end = false;
     bool set_end = true;
@@ -1,6 +1,7 @@
 #include "knapsacksolver/tester.hpp"
 #include "knapsacksolver/algorithms/minknap.hpp"
 #include "knapsacksolver/algorithms/expknap.hpp"
+#include "knapsacksolver/generator.hpp"
 
 using namespace knapsacksolver;
 
@@ -37,12 +38,75 @@ Output expknap_combocore_test(Instance& ins)
     return expknap(ins, p);
 }
 
+Output expknap_parallel_test(Instance& ins)
+{
+    Info info = Info()
+        //.set_verbose(true)
+        //.set_log2stderr(true)
+        ;
+    ExpknapOptionalParameters p;
+    p.info = info;
+    p.thread_number = 3;
+    p.parallel_depth = 1000;
+    return expknap(ins, p);
+}
+
+Output expknap_bestfirst_test(Instance& ins)
+{
+    Info info = Info()
+        //.set_verbose(true)
+        //.set_log2stderr(true)
+        ;
+    ExpknapOptionalParameters p;
+    p.info = info;
+    p.best_first = true;
+    return expknap(ins, p);
+}
+
+Output expknap_bestfirst_small_test(Instance& ins)
+{
+    Info info = Info()
+        //.set_verbose(true)
+        //.set_log2stderr(true)
+        ;
+    ExpknapOptionalParameters p;
+    p.info = info;
+    p.best_first = true;
+    p.best_first_node_number_max = 4;
+    return expknap(ins, p);
+}
+
 std::vector<Output (*)(Instance&)> f = {
         minknap_test,
         expknap_test,
         expknap_combocore_test,
+        expknap_parallel_test,
+        expknap_bestfirst_test,
+        expknap_bestfirst_small_test,
 };
 
 TEST(expknap, TEST)  { test(TEST, f, SOPT); }
 TEST(expknap, SMALL) { test(SMALL, f, SOPT); }
 
+
+TEST(expknap, PARALLEL)
+{
+    for (Seed s = 0; s < 5; ++s) {
+        Generator data;
+        data.n = 200;
+        data.t = "sc";
+        data.r = 100;
+        data.h = 10;
+        data.s = s;
+        Instance instance = data.generate();
+        Instance instance_2 = data.generate();
+
+        ExpknapOptionalParameters p;
+        ExpknapOutput output = expknap(instance, p);
+        p.thread_number = 4;
+        ExpknapOutput output_2 = expknap(instance_2, p);
+        EXPECT_EQ(output_2.lower_bound, output.lower_bound);
+        EXPECT_EQ(output_2.upper_bound, output.upper_bound);
+        EXPECT_EQ(output_2.solution.profit(), output.solution.profit());
+    }
+}
@@ -9,12 +9,24 @@
 
 using namespace knapsacksolver;
 
+template <typename PartSol, typename Offset>
 void minknap_main(Instance& instance, MinknapOptionalParameters& p, MinknapOutput& output);
 
+template <typename PartSol>
+void minknap_main_typed(Instance& instance, MinknapOptionalParameters& p, MinknapOutput& output)
+{
+    switch (instance.state_offset_size()) {
+    case 4: minknap_main<PartSol, int32_t>(instance, p, output); break;
+    default: minknap_main<PartSol, int64_t>(instance, p, output); break;
+    }
+}
+
 MinknapOutput knapsacksolver::minknap(Instance& instance, MinknapOptionalParameters p)
 {
     VER(p.info, "*** minknap"
             << " -k " << p.partial_solution_size
+            << " -t " << p.thread_number
+            << " -d " << p.decision_trail_size
             << ((p.greedy)? " -g": "")
             << " -p " << p.pairing
             << " -s " << p.surrelax
@@ -23,6 +35,8 @@ MinknapOutput knapsacksolver::minknap(Instance& instance, MinknapOptionalParamet
 
     LOG_FOLD_START(p.info, "*** minknap"
             << " -k " << p.partial_solution_size
+            << " -t " << p.thread_number
+            << " -d " << p.decision_trail_size
             << ((p.greedy)? " -g": "")
             << " -p " << p.pairing
             << " -s " << p.surrelax
@@ -34,7 +48,15 @@ MinknapOutput knapsacksolver::minknap(Instance& instance, MinknapOptionalParamet
         p.end = &end;
 
     MinknapOutput output(instance, p.info);
-    minknap_main(instance, p, output);
+    p.partial_solution_size = std::min(p.partial_solution_size, PARTSOL_SIZE_MAX);
+    switch (partsol_word_size(p.partial_solution_size)) {
+    case 64: minknap_main_typed<uint64_t>(instance, p, output); break;
+#if defined(KNAPSACKSOLVER_PARTSOL_INT128)
+    case 128: minknap_main_typed<unsigned __int128>(instance, p, output); break;
+#endif
+    case 256: minknap_main_typed<std::bitset<256>>(instance, p, output); break;
+    default: minknap_main_typed<std::bitset<512>>(instance, p, output); break;
+    }
 
     LOG_FOLD_END(p.info, "minknap");
     return output.algorithm_end(p.info);
@@ -42,19 +64,62 @@ MinknapOutput knapsacksolver::minknap(Instance& instance, MinknapOptionalParamet
 
 /******************************************************************************/
 
+template <typename PartSol>
 struct MinknapState
 {
     Weight w;
     Profit p;
-    PartSol2 sol;
+    PartSol sol;
+    StateIdx trail;
 };
 
-std::ostream& operator<<(std::ostream& os, const MinknapState& s)
+template <typename PartSol>
+std::ostream& operator<<(std::ostream& os, const MinknapState<PartSol>& s)
 {
     os << "(" << s.w << " " << s.p << ")";
     return os;
 }
 
+/**
+ * List of states sorted by strictly increasing weights and profits, stored as
+ * a structure of arrays. The vectors may be larger than size.
+ *
+ * Weights and profits are stored as offsets from (w_origin, p_origin), the
+ * break solution, so that they fit in an Offset of 4 bytes if
+ * Instance::state_offset_size() == 4.
+ */
+template <typename PartSol, typename Offset>
+struct MinknapStateList
+{
+    std::vector<Offset> w;
+    std::vector<Offset> p;
+    std::vector<PartSol> sol;
+    /** Decision trail node of each state, empty if the trail is disabled. */
+    std::vector<StateIdx> trail;
+    StateIdx size = 0;
+    Weight w_origin = 0;
+    Profit p_origin = 0;
+
+    MinknapState<PartSol> state(StateIdx i) const
+    {
+        return {w_origin + w[i], p_origin + p[i], sol[i], (trail.empty())? 0: trail[i]};
+    }
+};
+
+/**
+ * Node of the decision trail. The partial solutions only store the last items
+ * added. Therefore, each time all of them have been replaced, the partial
+ * solution of each state is saved in a node, with a pointer to the previous
+ * node of the state. Node 0 is the root.
+ */
+template <typename PartSol>
+struct MinknapTrailNode
+{
+    PartSol sol;
+    StateIdx parent;
+};
+
+template <typename PartSol, typename Offset>
 struct MinknapInternalData
 {
     MinknapInternalData(Instance& instance, MinknapOptionalParameters& p, MinknapOutput& output):
@@ -62,20 +127,28 @@ struct MinknapInternalData
     Instance& instance;
     MinknapOptionalParameters& p;
     MinknapOutput& output;
-    PartSolFactory2 psolf;
+    PartSolFactory2<PartSol> psolf;
     ItemPos s;
     ItemPos t;
     Weight w_max;
-    std::vector<MinknapState> l0;
-    std::vector<MinknapState> l;
-    MinknapState best_state;
+    MinknapStateList<PartSol, Offset> l0;
+    MinknapStateList<PartSol, Offset> l;
+    MinknapState<PartSol> best_state;
+    /** Decision trail, empty if disabled.  */
+    std::vector<MinknapTrailNode<PartSol>> trail;
+    /** Items of the partial solutions saved at each level of the trail.  */
+    std::vector<std::vector<ItemPos>> trail_items;
     std::vector<std::thread> threads;
 };
 
-void add_item(MinknapInternalData& d);
-void remove_item(MinknapInternalData& d);
-void minknap_update_bounds(MinknapInternalData& d);
+template <typename PartSol, typename Offset>
+void add_item(MinknapInternalData<PartSol, Offset>& d);
+template <typename PartSol, typename Offset>
+void remove_item(MinknapInternalData<PartSol, Offset>& d);
+template <typename PartSol, typename Offset>
+void minknap_update_bounds(MinknapInternalData<PartSol, Offset>& d);
 
+template <typename PartSol, typename Offset>
 void minknap_main(Instance& instance, MinknapOptionalParameters& p, MinknapOutput& output)
 {
     output.recursive_call_number++;
@@ -84,7 +157,7 @@ void minknap_main(Instance& instance, MinknapOptionalParameters& p, MinknapOutpu
             << std::endl);
     LOG_FOLD(p.info, instance);
 
-    MinknapInternalData d(instance, p, output);
+    MinknapInternalData<PartSol, Offset> d(instance, p, output);
     Weight  c = instance.reduced_capacity();
     ItemPos n = instance.reduced_item_number();
 
@@ -140,13 +213,22 @@ void minknap_main(Instance& instance, MinknapOptionalParameters& p, MinknapOutpu
     // Recursion
     Weight w_bar = instance.break_solution()->weight();
     Profit p_bar = instance.break_solution()->profit();
-    d.l0 = {{.w = w_bar, .p = p_bar, .sol = 0}};
+    d.l0.w = {0};
+    d.l0.p = {0};
+    d.l0.sol = {PartSol()};
+    d.l0.size = 1;
+    if (p.decision_trail_size > 0) {
+        d.l0.trail = {0};
+        d.trail = {{PartSol(), -1}};
+    }
+    d.l0.w_origin = w_bar;
+    d.l0.p_origin = p_bar;
     d.s = instance.break_item() - 1;
     d.t = instance.break_item();
     d.w_max = w_bar;
-    d.best_state = d.l0.front();
+    d.best_state = d.l0.state(0);
     LOG_FOLD(p.info, instance);
-    while (!d.l0.empty() && (d.t <= instance.last_item() || d.s >= instance.first_item())) {
+    while (d.l0.size > 0 && (d.t <= instance.last_item() || d.s >= instance.first_item())) {
         minknap_update_bounds(d); // Update bounds
         if (!p.info.check_time()) {
             if (p.set_end)
@@ -231,6 +313,20 @@ void minknap_main(Instance& instance, MinknapOptionalParameters& p, MinknapOutpu
     if (output.lower_bound == output.solution.profit())
         return;
 
+    // Retrieve the solution of the best state from the decision trail.
+    if (!d.trail.empty()) {
+        Solution sol = *instance.break_solution();
+        d.psolf.update_solution(d.best_state.sol, sol);
+        ItemPos level = d.trail_items.size() - 1;
+        for (StateIdx k = d.best_state.trail; k != 0; k = d.trail[k].parent, --level)
+            for (ItemPos j = 0; j < d.psolf.size(); ++j)
+                sol.set(d.trail_items[level][j], d.psolf.contains(d.trail[k].sol, j));
+        assert(sol.profit() == d.best_state.p);
+        output.update_sol(sol, std::stringstream("decision trail"), p.info);
+        LOG_FOLD_END(p.info, "minknap_main");
+        return;
+    }
+
     //assert(best_state_.p >= lb_);
     LOG_FOLD(p.info, instance);
     instance.set_first_item(d.s + 1, p.info);
@@ -241,12 +337,338 @@ void minknap_main(Instance& instance, MinknapOptionalParameters& p, MinknapOutpu
     assert(instance.reduced_capacity() >= 0);
 
     LOG_FOLD_END(p.info, "minknap_main");
-    minknap_main(instance, p, output);
+    minknap_main<PartSol, Offset>(instance, p, output);
 }
 
 /******************************************************************************/
 
-void add_item(MinknapInternalData& d)
+/**
+ * Bounds used to filter the states during a merge. A state (w, p) is kept iff
+ * its Dembo upper bound is greater than lb, that is:
+ * - if w <= c: p + (c - w) * bp / bw > lb
+ * - if w > c: p + ((c - w) * sp + 1) / sw - 1 > lb
+ * These tests are done without division. They only depend on c - w and
+ * lb - p, so c, lb, w and p can be offsets from the same origin.
+ */
+struct MinknapBound
+{
+    Weight c;
+    Profit lb;
+    /** Item used for the bound of the states which fit, bp = 0 if none. */
+    Profit bp;
+    Weight bw;
+    Profit d_max_b;
+    /** Item used for the bound of the states which don't fit. */
+    bool s_none;
+    /** If there is no such item, the bound is 0 and s_none_keep = (0 > lb). */
+    bool s_none_keep;
+    Profit sp;
+    Weight sw;
+    Profit d_max_s;
+};
+
+MinknapBound minknap_bound(const Instance& instance, ItemPos sx, ItemPos tx, Profit lb,
+        Weight w_origin, Profit p_origin)
+{
+    MinknapBound bound;
+    bound.c = instance.capacity() - w_origin;
+    bound.lb = lb - p_origin;
+    bound.bp = (tx <= instance.last_item())? instance.item(tx).p: 0;
+    bound.bw = (tx <= instance.last_item())? instance.item(tx).w: 1;
+    bound.d_max_b = INT_FAST64_MAX / bound.bw;
+    bound.s_none = (sx < instance.first_item());
+    bound.s_none_keep = (0 > lb);
+    bound.sp = (!bound.s_none)? instance.item(sx).p: 0;
+    bound.sw = (!bound.s_none)? instance.item(sx).w: 1;
+    bound.d_max_s = INT_FAST64_MAX / bound.sw;
+    return bound;
+}
+
+inline bool minknap_keep(const MinknapBound& bound, Weight w, Profit p)
+{
+    Profit d = bound.lb - p + 1;
+    if (w <= bound.c) // (c - w) * bp / bw >= d
+        return d <= 0 || (d <= bound.d_max_b && (bound.c - w) * bound.bp >= d * bound.bw);
+    if (bound.s_none)
+        return bound.s_none_keep;
+    // x / sw >= e, where x = (c - w) * sp + 1 and the division truncates
+    // toward zero.
+    Profit e = d + 1;
+    Profit x = (bound.c - w) * bound.sp + 1;
+    return (e > 0)?
+        (e <= bound.d_max_s && x >= e * bound.sw):
+        (1 - e > bound.d_max_s || x > (e - 1) * bound.sw);
+}
+
+/**
+ * Result of the merge of a chunk: number of states written and maximum
+ * profit of all the states of the chunk, kept or not.
+ */
+struct MinknapMergeChunk
+{
+    StateIdx size;
+    Profit p_max;
+};
+
+/**
+ * Merge the states ia_first.. of d.l0 (with solution sol_a(sol)) and the
+ * states ib_first.. of d.l0 shifted by (dw, dp) (with solution sol_b(sol)),
+ * until i_number states have been read, and write the states which are kept
+ * at the beginning of (w1, p1, s1, t1). t1 is NULL if the decision trail is
+ * disabled.
+ *
+ * A state is dominated iff its profit is not greater than the profits of all
+ * the previous states; the states removed by the upper bound can be taken
+ * into account since the states they dominate have a smaller upper bound.
+ * Therefore, each state is tested once against p_max and, if it is not
+ * dominated, once against the bound.
+ */
+template <typename PartSol, typename Offset, typename SolA, typename SolB>
+MinknapMergeChunk minknap_merge_chunk(const MinknapStateList<PartSol, Offset>& l0,
+        StateIdx na, StateIdx nb, StateIdx ia, StateIdx ib, StateIdx i_number,
+        Weight dw, Profit dp, const MinknapBound& bound, SolA sol_a, SolB sol_b,
+        Offset* w1, Offset* p1, PartSol* s1, StateIdx* t1)
+{
+    const Offset* w0 = l0.w.data();
+    const Offset* p0 = l0.p.data();
+    const PartSol* s0 = l0.sol.data();
+    const StateIdx* t0 = l0.trail.data();
+    Profit p_max = INT_FAST64_MIN;
+    Weight w_last = INT_FAST64_MIN;
+    StateIdx k = 0;
+    for (StateIdx i = 0; i < i_number; ++i) {
+        bool b = (ia == na) || (ib < nb && (Weight)w0[ib] + dw < w0[ia]);
+        StateIdx src = (b)? ib++: ia++;
+        Weight w = (Weight)w0[src] + ((b)? dw: 0);
+        Profit p = (Profit)p0[src] + ((b)? dp: 0);
+        if (p <= p_max)
+            continue;
+        p_max = p;
+        if (!minknap_keep(bound, w, p))
+            continue;
+        k -= (w == w_last);
+        w1[k] = (Offset)w;
+        p1[k] = (Offset)p;
+        s1[k] = (b)? sol_b(s0[src]): sol_a(s0[src]);
+        if (t1 != NULL)
+            t1[k] = t0[src];
+        ++k;
+        w_last = w;
+    }
+    return {k, p_max};
+}
+
+/**
+ * Number of states of d.l0 among the first i states of the merge of the
+ * states 0..na-1 of d.l0 and of the states 0..nb-1 of d.l0 shifted by dw
+ * (merge-path co-ranking). When weights are equal, the states of d.l0 come
+ * first.
+ */
+template <typename PartSol, typename Offset>
+StateIdx minknap_merge_corank(const MinknapStateList<PartSol, Offset>& l0,
+        StateIdx na, StateIdx nb, StateIdx i, Weight dw)
+{
+    const Offset* w0 = l0.w.data();
+    StateIdx lo = std::max((StateIdx)0, i - nb);
+    StateIdx hi = std::min(i, na);
+    while (lo < hi) {
+        StateIdx mid = (lo + hi) / 2;
+        if ((Weight)w0[i - mid - 1] + dw >= w0[mid]) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * Merge the states of d.l0 (with solution sol_a(sol)) and the states of d.l0
+ * shifted by (dw, dp) (with solution sol_b(sol)) into d.l, removing the
+ * states heavier than w_max, the dominated states and the states whose
+ * upper bound is not greater than bound.lb. Then swap d.l0 and d.l.
+ * w_max and bound are relative to the origin of d.l0.
+ *
+ * Since both inputs are sorted, the states lighter than w_max form a prefix
+ * of each input.
+ *
+ * If there are at least d.p.parallel_merge_threshold states to merge, the
+ * merge is split into d.p.thread_number chunks of the same size which are
+ * merged in parallel, each one into its own part of d.l. Then, the states of
+ * each chunk dominated by a state of a previous chunk, which form a prefix of
+ * the chunk, are removed, and the chunks are moved next to each other.
+ */
+template <typename PartSol, typename Offset, typename SolA, typename SolB>
+void minknap_merge(MinknapInternalData<PartSol, Offset>& d, Weight dw, Profit dp, Weight w_max,
+        const MinknapBound& bound, SolA sol_a, SolB sol_b)
+{
+    const MinknapStateList<PartSol, Offset>& l0 = d.l0;
+    MinknapStateList<PartSol, Offset>& l = d.l;
+    const Offset* w0 = l0.w.data();
+    StateIdx na = std::upper_bound(w0, w0 + l0.size, w_max) - w0;
+    StateIdx nb = std::upper_bound(w0, w0 + l0.size, w_max - dw) - w0;
+
+    l.w.resize(na + nb + 1);
+    l.p.resize(na + nb + 1);
+    l.sol.resize(na + nb + 1);
+    if (!d.trail.empty())
+        l.trail.resize(na + nb + 1);
+    l.w_origin = l0.w_origin;
+    l.p_origin = l0.p_origin;
+    Offset* w1 = l.w.data();
+    Offset* p1 = l.p.data();
+    PartSol* s1 = l.sol.data();
+    StateIdx* t1 = (!d.trail.empty())? l.trail.data(): NULL;
+
+    Counter chunk_number = (na + nb >= d.p.parallel_merge_threshold)?
+        std::max((Counter)1, d.p.thread_number): 1;
+    if (chunk_number == 1) {
+        l.size = minknap_merge_chunk(l0, na, nb, 0, 0, na + nb,
+                dw, dp, bound, sol_a, sol_b, w1, p1, s1, t1).size;
+        std::swap(d.l0, d.l);
+        return;
+    }
+
+    std::vector<StateIdx> i_first(chunk_number + 1);
+    for (Counter c = 0; c <= chunk_number; ++c)
+        i_first[c] = (na + nb) * c / chunk_number;
+    std::vector<MinknapMergeChunk> chunks(chunk_number);
+    auto merge_chunk = [&](Counter c)
+    {
+        StateIdx ia = minknap_merge_corank(l0, na, nb, i_first[c], dw);
+        StateIdx ib = i_first[c] - ia;
+        chunks[c] = minknap_merge_chunk(l0, na, nb, ia, ib,
+                i_first[c + 1] - i_first[c], dw, dp, bound, sol_a, sol_b,
+                w1 + i_first[c], p1 + i_first[c], s1 + i_first[c],
+                (t1 != NULL)? t1 + i_first[c]: NULL);
+    };
+    std::vector<std::thread> threads;
+    for (Counter c = 1; c < chunk_number; ++c)
+        threads.push_back(std::thread(merge_chunk, c));
+    merge_chunk(0);
+    for (std::thread& thread: threads)
+        thread.join();
+
+    StateIdx k = chunks[0].size;
+    Profit p_max = chunks[0].p_max;
+    for (Counter c = 1; c < chunk_number; ++c) {
+        StateIdx first = i_first[c];
+        StateIdx last = i_first[c] + chunks[c].size;
+        first = std::upper_bound(p1 + first, p1 + last, p_max) - p1;
+        p_max = std::max(p_max, chunks[c].p_max);
+        if (first == last)
+            continue;
+        if (k > 0 && w1[k - 1] == w1[first])
+            k--;
+        std::copy(w1 + first, w1 + last, w1 + k);
+        std::copy(p1 + first, p1 + last, p1 + k);
+        std::copy(s1 + first, s1 + last, s1 + k);
+        if (t1 != NULL)
+            std::copy(t1 + first, t1 + last, t1 + k);
+        k += last - first;
+    }
+    l.size = k;
+    std::swap(d.l0, d.l);
+}
+
+/**
+ * Remove the nodes of the decision trail which are not ancestors of a state
+ * of d.l0 or of the best state. Nodes are always created after their parent,
+ * so the remaining ones keep their order.
+ */
+template <typename PartSol, typename Offset>
+void minknap_compact_trail(MinknapInternalData<PartSol, Offset>& d)
+{
+    std::vector<StateIdx> node_new(d.trail.size(), -1);
+    node_new[0] = 0;
+    auto mark = [&d, &node_new](StateIdx k)
+    {
+        for (; node_new[k] == -1; k = d.trail[k].parent)
+            node_new[k] = 1;
+    };
+    for (StateIdx i = 0; i < d.l0.size; ++i)
+        mark(d.l0.trail[i]);
+    mark(d.best_state.trail);
+
+    StateIdx k_new = 1;
+    for (StateIdx k = 1; k < (StateIdx)d.trail.size(); ++k) {
+        if (node_new[k] == -1)
+            continue;
+        node_new[k] = k_new;
+        d.trail[k_new] = {d.trail[k].sol, node_new[d.trail[k].parent]};
+        k_new++;
+    }
+    d.trail.resize(k_new);
+    for (StateIdx i = 0; i < d.l0.size; ++i)
+        d.l0.trail[i] = node_new[d.l0.trail[i]];
+    d.best_state.trail = node_new[d.best_state.trail];
+}
+
+/**
+ * If the next item added to the partial solutions replaces the oldest one,
+ * save the partial solutions of the states of d.l0 and of the best state in
+ * the decision trail.
+ *
+ * If the trail would exceed d.p.decision_trail_size nodes, it is compacted
+ * first. If it then still fills more than half of the arena, compacting again
+ * at each level would be too slow, so it is disabled and the solution will be
+ * retrieved by solving the reduced instance again.
+ */
+template <typename PartSol, typename Offset>
+void minknap_update_trail(MinknapInternalData<PartSol, Offset>& d)
+{
+    if (d.trail.empty() || !d.psolf.cycle_end())
+        return;
+    if ((StateIdx)d.trail.size() + d.l0.size + 1 > d.p.decision_trail_size) {
+        minknap_compact_trail(d);
+        if (2 * ((StateIdx)d.trail.size() + d.l0.size + 1) > d.p.decision_trail_size) {
+            LOG(d.p.info, "decision trail disabled" << std::endl);
+            d.trail.clear();
+            d.trail.shrink_to_fit();
+            d.trail_items.clear();
+            d.l0.trail.clear();
+            d.l.trail.clear();
+            return;
+        }
+    }
+    d.trail_items.push_back(d.psolf.indices());
+    StateIdx* t0 = d.l0.trail.data();
+    for (StateIdx i = 0; i < d.l0.size; ++i) {
+        d.trail.push_back({d.l0.sol[i], t0[i]});
+        t0[i] = d.trail.size() - 1;
+    }
+    d.trail.push_back({d.best_state.sol, d.best_state.trail});
+    d.best_state.trail = d.trail.size() - 1;
+}
+
+/**
+ * Update the lower bound and the best state with the last state of d.l0
+ * which fits in the knapsack, which is the most profitable one.
+ */
+template <typename PartSol, typename Offset>
+void minknap_update_best_state(MinknapInternalData<PartSol, Offset>& d, Profit lb)
+{
+    Instance& instance = d.instance;
+    Info& info = d.p.info;
+    const Offset* w0 = d.l0.w.data();
+    StateIdx i = std::upper_bound(w0, w0 + d.l0.size,
+            instance.capacity() - d.l0.w_origin) - w0 - 1;
+    if (i < 0)
+        return;
+    MinknapState<PartSol> state = d.l0.state(i);
+    if (state.p <= lb)
+        return;
+    if (d.output.recursive_call_number == 1) {
+        std::stringstream ss;
+        ss << "it " << d.t - d.s << " (lb)";
+        d.output.update_lb(state.p, ss, info);
+    }
+    d.best_state = state;
+    assert(d.output.lower_bound <= d.output.upper_bound);
+}
+
+template <typename PartSol, typename Offset>
+void add_item(MinknapInternalData<PartSol, Offset>& d)
 {
     Instance& instance = d.instance;
     Info& info = d.p.info;
@@ -259,108 +681,27 @@ void add_item(MinknapInternalData& d)
             << " item " << instance.item(d.t - 1)
             << " lb " << lb
             << std::endl);
+    minknap_update_trail(d);
     d.psolf.add_item(d.t - 1);
     LOG(info, "psolf " << d.psolf.print() << std::endl);
     d.best_state.sol = d.psolf.remove(d.best_state.sol);
-    Weight c = instance.capacity();
     Weight wt = instance.item(d.t - 1).w;
     Profit pt = instance.item(d.t - 1).p;
     ItemPos sx = instance.bound_item_left(d.s, lb, info);
     ItemPos tx = instance.bound_item_right(d.t, lb, info);
     Weight w_max = instance.capacity() + d.w_max - instance.reduced_solution()->weight();
 
-    d.l.clear();
-    std::vector<MinknapState>::iterator it = d.l0.begin();
-    std::vector<MinknapState>::iterator it1 = d.l0.begin();
-    while (it != d.l0.end() || it1 != d.l0.end()) {
-        if (it == d.l0.end() || it->w > it1->w + wt) {
-            Weight w = it1->w + wt;
-            if (w > w_max) {
-                LOG(info, " ×" << std::endl);
-                it1++;
-                continue;
-            }
-
-            Profit p = it1->p + pt;
-            if (!d.l.empty() && p <= d.l.back().p) {
-                LOG(info, " ×" << std::endl);
-                it1++;
-                continue;
-            }
-
-            Profit ub = (w <= c)?
-                ub_dembo(instance, tx, p, c - w):
-                ub_dembo_rev(instance, sx, p, c - w);
-            LOG(info, " ub " << ub << " lb " << lb);
-            if (ub <= lb) {
-                LOG(info, " ×" << std::endl);
-                it1++;
-                continue;
-            }
-
-            MinknapState s1{w, p, d.psolf.add(it1->sol)};
-            LOG(info, "state " << *it1 << " => " << s1);
-
-            // Update lower bound
-            if (s1.w <= c && s1.p > lb) {
-                if (d.output.recursive_call_number == 1) {
-                    std::stringstream ss;
-                    ss << "it " << d.t - d.s << " (lb)";
-                    d.output.update_lb(s1.p, ss, info);
-                    lb = s1.p;
-                }
-                d.best_state = s1;
-                assert(d.output.lower_bound <= d.output.upper_bound);
-            }
-
-            if (!d.l.empty() && s1.w == d.l.back().w) {
-                d.l.back() = s1;
-            } else {
-                d.l.push_back(s1);
-            }
-            LOG(info, " ok" << std::endl);
-            it1++;
-        } else {
-            assert(it != d.l0.end());
-            LOG(info, "state " << *it);
-
-            if (it->w > w_max) {
-                LOG(info, " ×" << std::endl);
-                it++;
-                continue;
-            }
-
-            if (!d.l.empty() && it->p <= d.l.back().p) {
-                LOG(info, " ×" << std::endl);
-                it++;
-                continue;
-            }
-
-            Profit ub = (it->w <= c)?
-                ub_dembo(instance, tx, it->p, c - it->w):
-                ub_dembo_rev(instance, sx, it->p, c - it->w);
-            LOG(info, " ub " << ub << " lb " << lb);
-            if (ub <= lb) {
-                LOG(info, " ×" << std::endl);
-                it++;
-                continue;
-            }
-
-            it->sol = d.psolf.remove(it->sol);
-            if (!d.l.empty() && it->w == d.l.back().w) {
-                d.l.back() = *it;
-            } else {
-                d.l.push_back(*it);
-            }
-            LOG(info, " ok" << std::endl);
-            ++it;
-        }
-    }
-    d.l0.swap(d.l);
-    LOG_FOLD_END(info, "add_item");
+    const PartSolFactory2<PartSol>& psolf = d.psolf;
+    minknap_merge(d, wt, pt, w_max - d.l0.w_origin,
+            minknap_bound(instance, sx, tx, lb, d.l0.w_origin, d.l0.p_origin),
+            [&psolf](const PartSol& sol) { return psolf.remove(sol); },
+            [&psolf](const PartSol& sol) { return psolf.add(sol); });
+    minknap_update_best_state(d, lb);
+    LOG_FOLD_END(info, "add_item " << d.l0.size);
 }
 
-void remove_item(MinknapInternalData& d)
+template <typename PartSol, typename Offset>
+void remove_item(MinknapInternalData<PartSol, Offset>& d)
 {
     Instance& instance = d.instance;
     Info& info = d.p.info;
@@ -372,10 +713,10 @@ void remove_item(MinknapInternalData& d)
             << " t " << d.t
             << " item " << instance.item(d.s + 1)
             << " lb " << lb << std::endl);
+    minknap_update_trail(d);
     d.psolf.add_item(d.s + 1);
     LOG(info, "psolf " << d.psolf.print() << std::endl);
     d.best_state.sol = d.psolf.add(d.best_state.sol);
-    Weight c = instance.capacity();
     Weight ws = instance.item(d.s + 1).w;
     Profit ps = instance.item(d.s + 1).p;
     d.w_max -= ws;
@@ -383,99 +724,19 @@ void remove_item(MinknapInternalData& d)
     ItemPos tx = instance.bound_item_right(d.t, lb, info);
     Weight w_max = instance.capacity() + d.w_max - instance.reduced_solution()->weight();
 
-    d.l.clear();
-    std::vector<MinknapState>::iterator it = d.l0.begin();
-    std::vector<MinknapState>::iterator it1 = d.l0.begin();
-    while (it != d.l0.end() || it1 != d.l0.end()) {
-        if (it1 == d.l0.end() || it->w <= it1->w - ws) {
-            LOG(info, "state " << *it);
-
-            if (it->w > w_max) {
-                LOG(info, " ×" << std::endl);
-                it++;
-                continue;
-            }
-
-            if (!d.l.empty() && it->p <= d.l.back().p) {
-                LOG(info, " ×" << std::endl);
-                it++;
-                continue;
-            }
-
-            Profit ub = (it->w <= c)?
-                ub_dembo(instance, tx, it->p, c - it->w):
-                ub_dembo_rev(instance, sx, it->p, c - it->w);
-            LOG(info, " ub " << ub << " lb " << lb);
-            if (ub <= lb) {
-                LOG(info, " ×" << std::endl);
-                it++;
-                continue;
-            }
-
-            it->sol = d.psolf.add(it->sol);
-            if (!d.l.empty() && it->w == d.l.back().w) {
-                d.l.back() = *it;
-            } else {
-                d.l.push_back(*it);
-            }
-            LOG(info, " ok" << std::endl);
-            ++it;
-        } else {
-            Weight w = it1->w - ws;
-            if (w > w_max) {
-                LOG(info, " ×" << std::endl);
-                it1++;
-                continue;
-            }
-
-            Profit p = it1->p - ps;
-            if (!d.l.empty() && p <= d.l.back().p) {
-                LOG(info, " ×" << std::endl);
-                it1++;
-                continue;
-            }
-
-            Profit ub = (w <= c)?
-                ub_dembo(instance, tx, p, c - w):
-                ub_dembo_rev(instance, sx, p, c - w);
-            LOG(info, " ub " << ub << " lb " << lb);
-            if (ub <= lb) {
-                LOG(info, " ×" << std::endl);
-                it1++;
-                continue;
-            }
-
-            MinknapState s1{it1->w - ws, it1->p - ps, d.psolf.remove(it1->sol)};
-            LOG(info, "state " << *it1 << " => " << s1);
-
-            // Update lower bound
-            if (s1.w <= c && s1.p > lb) {
-                if (d.output.recursive_call_number == 1) {
-                    std::stringstream ss;
-                    ss << "it " << d.t - d.s << " (lb)";
-                    d.output.update_lb(s1.p, ss, info);
-                    lb = s1.p;
-                }
-                d.best_state = s1;
-                assert(d.output.lower_bound <= d.output.upper_bound);
-            }
-
-            if (!d.l.empty() && s1.w == d.l.back().w) {
-                d.l.back() = s1;
-            } else {
-                d.l.push_back(s1);
-            }
-            LOG(info, " ok" << std::endl);
-            it1++;
-        }
-    }
-    d.l0.swap(d.l);
-    LOG_FOLD_END(info, "remove_item");
+    const PartSolFactory2<PartSol>& psolf = d.psolf;
+    minknap_merge(d, -ws, -ps, w_max - d.l0.w_origin,
+            minknap_bound(instance, sx, tx, lb, d.l0.w_origin, d.l0.p_origin),
+            [&psolf](const PartSol& sol) { return psolf.add(sol); },
+            [&psolf](const PartSol& sol) { return psolf.remove(sol); });
+    minknap_update_best_state(d, lb);
+    LOG_FOLD_END(info, "remove_item " << d.l0.size);
 }
 
 /******************************************************************************/
 
-ItemPos minknap_find_state(MinknapInternalData& d, bool right)
+template <typename PartSol, typename Offset>
+ItemPos minknap_find_state(MinknapInternalData<PartSol, Offset>& d, bool right)
 {
     Instance& instance = d.instance;
     LOG_FOLD_START(d.p.info, "minknap_find_state" << std::endl);
@@ -493,31 +754,13 @@ ItemPos minknap_find_state(MinknapInternalData& d, bool right)
         Weight w = (right)?
             instance.capacity() - instance.item(t).w:
             instance.capacity() + instance.item(t).w;
-        if (d.l0.front().w > w)
+        const Offset* w0 = d.l0.w.data();
+        StateIdx f = std::upper_bound(w0, w0 + d.l0.size, w - d.l0.w_origin) - w0 - 1;
+        if (f < 0)
             continue;
-        ItemPos f = 0;
-        ItemPos l = d.l0.size() - 1; // l0_[l] > w
-        while (f + 1 < l) {
-            LOG(d.p.info, "f " << f << " l " << l << std::endl);
-            ItemPos m = (f + l) / 2;
-            if (d.l0[m].w >= w) {
-                assert(l != m);
-                l = m;
-            } else {
-                assert(f != m);
-                f = m;
-            }
-        }
-        LOG(d.p.info, "f " << f << " l " << l << std::endl);
-        if (f != (StateIdx)d.l0.size() - 1 && d.l0[f + 1].w <= w)
-            f++;
-        LOG(d.p.info, "f " << f << " l " << l << std::endl);
-        assert(f < (StateIdx)d.l0.size());
-        assert(d.l0[f].w <= w);
-        assert(f == (StateIdx)d.l0.size() - 1 || d.l0[f + 1].w > w);
         Profit lb = (right)?
-            d.l0[f].p + instance.item(t).p:
-            d.l0[f].p - instance.item(t).p;
+            d.l0.p_origin + d.l0.p[f] + instance.item(t).p:
+            d.l0.p_origin + d.l0.p[f] - instance.item(t).p;
         if (lb0 < lb) {
             j = t;
             lb0 = lb;
@@ -527,12 +770,13 @@ ItemPos minknap_find_state(MinknapInternalData& d, bool right)
     return j;
 }
 
-void minknap_update_bounds(MinknapInternalData& d)
+template <typename PartSol, typename Offset>
+void minknap_update_bounds(MinknapInternalData<PartSol, Offset>& d)
 {
     Instance& instance = d.instance;
     Info& info = d.p.info;
 
-    if (d.p.surrelax >= 0 && d.p.surrelax <= (StateIdx)d.l0.size()) {
+    if (d.p.surrelax >= 0 && d.p.surrelax <= d.l0.size) {
         d.p.surrelax = -1;
         std::function<Output (Instance&, Info, bool*)> func
             = [&d](Instance& instance, Info info, bool* end)
@@ -556,7 +800,7 @@ void minknap_update_bounds(MinknapInternalData& d)
                     .end      = d.p.end,
                     .info     = Info(info, true, "surrelax")}));
     }
-    if (d.p.pairing >= 0 && d.p.pairing <= (StateIdx)d.l0.size()) {
+    if (d.p.pairing >= 0 && d.p.pairing <= d.l0.size) {
         LOG_FOLD_START(info, "pairing" << std::endl);
         d.p.pairing *= 10;
 
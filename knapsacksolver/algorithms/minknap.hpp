@@ -17,6 +17,18 @@ struct MinknapOptionalParameters
     bool combo_core = false;
     ItemIdx partial_solution_size = 64;
 
+    // The merges of state lists with at least "parallel_merge_threshold"
+    // states are split into "thread_number" chunks merged in parallel.
+    Counter thread_number = 1;
+    StateIdx parallel_merge_threshold = 1 << 16;
+
+    // If "decision_trail_size" > 0, the partial solutions of the states are
+    // saved in a trail before they are overwritten, in an arena of at most
+    // "decision_trail_size" nodes. The optimal solution is then retrieved
+    // from the trail instead of by solving the reduced instance again. If the
+    // arena becomes too small, the algorithm falls back to the recursion.
+    StateIdx decision_trail_size = 0;
+
     // If "stop_if_end" == true, the algorithm will stop when *end"" becomes
     // equal to "true".
     // If end == NULL, then a new pointer will be allocated and deallocated.
@@ -50,6 +50,30 @@ Output minknap_3_test(Instance& ins)
     return minknap(ins, p);
 }
 
+Output minknap_128_test(Instance& ins)
+{
+    Info info = Info()
+        //.set_verbose(true)
+        //.set_log2stderr(true)
+        ;
+    auto p = MinknapOptionalParameters().set_pure();
+    p.info = info;
+    p.partial_solution_size = 128;
+    return minknap(ins, p);
+}
+
+Output minknap_512_test(Instance& ins)
+{
+    Info info = Info()
+        //.set_verbose(true)
+        //.set_log2stderr(true)
+        ;
+    auto p = MinknapOptionalParameters().set_pure();
+    p.info = info;
+    p.partial_solution_size = 512;
+    return minknap(ins, p);
+}
+
 Output minknap_combocore_k1_test(Instance& ins)
 {
     Info info = Info()
@@ -101,18 +125,94 @@ Output minknap_pairing_test(Instance& ins)
     return minknap(ins, p);
 }
 
+Output minknap_trail_test(Instance& ins)
+{
+    Info info = Info()
+        //.set_verbose(true)
+        //.set_log2stderr(true)
+        ;
+    auto p = MinknapOptionalParameters().set_combo();
+    p.info = info;
+    p.surrelax = -1;
+    p.decision_trail_size = 1 << 20;
+    return minknap(ins, p);
+}
+
+Output minknap_trail_small_test(Instance& ins)
+{
+    Info info = Info()
+        //.set_verbose(true)
+        //.set_log2stderr(true)
+        ;
+    auto p = MinknapOptionalParameters().set_pure();
+    p.info = info;
+    p.decision_trail_size = 16;
+    return minknap(ins, p);
+}
+
+Output minknap_parallel_merge_test(Instance& ins)
+{
+    Info info = Info()
+        //.set_verbose(true)
+        //.set_log2stderr(true)
+        ;
+    auto p = MinknapOptionalParameters().set_pure();
+    p.info = info;
+    p.thread_number = 3;
+    p.parallel_merge_threshold = 0;
+    return minknap(ins, p);
+}
+
 std::vector<Output (*)(Instance&)> f = {
         bellman_array_test,
         minknap_1_test,
         minknap_2_test,
         minknap_3_test,
+        minknap_128_test,
+        minknap_512_test,
         minknap_combocore_k1_test,
         minknap_combocore_k2_test,
         minknap_combocore_k3_test,
         minknap_pairing_test,
+        minknap_parallel_merge_test,
+        minknap_trail_test,
+        minknap_trail_small_test,
 };
 
 TEST(minknap, TEST)   { test(TEST, f); }
 TEST(minknap, SMALL)  { test(SMALL, f); }
 TEST(minknap, MEDIUM) { test(MEDIUM, f); }
 
+TEST(minknap, LARGE_COEFFICIENTS)
+{
+    // The sums of the weights and of the profits don't fit in 32 bits.
+    Weight k = (Weight)1 << 28;
+    Instance instance(5 * k, {
+            {3 * k, 4 * k},
+            {4 * k, 5 * k},
+            {2 * k, 3 * k}});
+    EXPECT_EQ(instance.state_offset_size(), 8);
+    Output output = minknap(instance, MinknapOptionalParameters().set_pure());
+    EXPECT_EQ(output.lower_bound, 7 * k);
+    EXPECT_EQ(output.solution.profit(), 7 * k);
+}
+
+TEST(minknap, DECISION_TRAIL)
+{
+    Generator data;
+    data.n = 1000;
+    data.t = "sc";
+    data.r = 10000;
+    data.h = 50;
+    data.s = 0;
+    Instance instance = data.generate();
+    Instance instance_2 = data.generate();
+
+    auto p = MinknapOptionalParameters().set_pure();
+    MinknapOutput output = minknap(instance, p);
+    p.decision_trail_size = 1 << 20;
+    MinknapOutput output_2 = minknap(instance_2, p);
+    EXPECT_EQ(output_2.solution.profit(), output.solution.profit());
+    EXPECT_EQ(output_2.recursive_call_number, 1);
+}
+
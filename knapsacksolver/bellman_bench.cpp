@@ -0,0 +1,121 @@
+#include "knapsacksolver/algorithms/dpkernels.hpp"
+
+#include <chrono>
+
+using namespace knapsacksolver;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+/**
+ * Compare the inner loop of the Bellman array DP before and after
+ * vectorization on random items with small coefficients, with 64 and 32 bits
+ * values.
+ *
+ * Then, compare the vectorized kernel with the cache-blocked kernel for
+ * capacities from 10^7 to argv[1] (default 10^8; 10^9 requires 4GB of
+ * memory).
+ */
+
+void update_scalar(std::vector<Profit>& values, Weight c, Weight wj, Profit pj)
+{
+    for (Weight w = c; w >= wj; w--)
+        if (values[w] < values[w - wj] + pj)
+            values[w] = values[w - wj] + pj;
+}
+
+template <typename T>
+double update_kernel(std::vector<T>& values, Weight c,
+        const std::vector<Weight>& w, const std::vector<Profit>& p)
+{
+    auto start = Clock::now();
+    for (ItemIdx j = 0; j < (ItemIdx)w.size(); ++j)
+        bellman_array_update<T>(&values[w[j]], &values[0], &values[w[j]], c - w[j] + 1, p[j]);
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int main(int argc, char *argv[])
+{
+    Weight c_max = (argc > 1)? std::stoll(argv[1]): 100000000;
+
+    std::mt19937_64 gen(0);
+    std::uniform_int_distribution<Weight> dist(1, 1000);
+    for (Weight c: {10000, 100000, 1000000, 10000000}) {
+        ItemIdx n = std::max((Weight)10, 100000000 / c);
+        std::vector<Weight> w(n);
+        std::vector<Profit> p(n);
+        for (ItemIdx j = 0; j < n; ++j) {
+            w[j] = dist(gen);
+            p[j] = dist(gen);
+        }
+
+        std::vector<Profit> values_1(c + 1, 0);
+        auto start_1 = Clock::now();
+        for (ItemIdx j = 0; j < n; ++j)
+            update_scalar(values_1, c, w[j], p[j]);
+        double t_1 = std::chrono::duration<double>(Clock::now() - start_1).count();
+
+        std::vector<Profit> values_2(c + 1, 0);
+        double t_2 = update_kernel(values_2, c, w, p);
+
+        // The optimal value is at most 1000 * n <= 10^7.
+        std::vector<int32_t> values_3(c + 1, 0);
+        double t_3 = update_kernel(values_3, c, w, p);
+
+        std::cout
+            << "c " << c
+            << " n " << n
+            << " scalar " << t_1 << "s"
+            << " kernel " << t_2 << "s"
+            << " speedup " << t_1 / t_2
+            << " kernel32 " << t_3 << "s"
+            << " speedup " << t_1 / t_3
+            << ((values_1 == values_2)? "": " ERROR, different values")
+            << ((std::equal(values_1.begin(), values_1.end(), values_3.begin()))? "": " ERROR, different values (32 bits)")
+            << std::endl;
+    }
+
+    for (Weight c = 10000000; c <= c_max; c *= 10) {
+        ItemIdx n = 64;
+        std::vector<Weight> w(n);
+        std::vector<int32_t> p(n);
+        for (ItemIdx j = 0; j < n; ++j) {
+            w[j] = dist(gen);
+            p[j] = dist(gen);
+        }
+        ItemIdx block_size = BELLMAN_ARRAY_BLOCK_BYTES
+            / ((1000 + 2 * BELLMAN_ARRAY_TILE_SIZE) * sizeof(int32_t));
+
+        std::vector<int32_t> values_1(c + 1, 0);
+        auto start_1 = Clock::now();
+        for (ItemIdx j = 0; j < n; ++j)
+            bellman_array_update(&values_1[w[j]], &values_1[0], &values_1[w[j]], c - w[j] + 1, p[j]);
+        double t_1 = std::chrono::duration<double>(Clock::now() - start_1).count();
+        values_1.clear();
+        values_1.shrink_to_fit();
+
+        std::vector<int32_t> values_2(c + 1, 0);
+        std::vector<int32_t> buffer;
+        auto start_2 = Clock::now();
+        for (ItemIdx j = 0; j < n; j += block_size) {
+            ItemIdx m = std::min(block_size, n - j);
+            bellman_array_update_tiled(values_2.data(), c, &w[j], &p[j], m, buffer);
+        }
+        double t_2 = std::chrono::duration<double>(Clock::now() - start_2).count();
+
+        // Each pass over the table reads and writes c + 1 values.
+        double gb = 2.0 * (c + 1) * sizeof(int32_t) / 1e9;
+        double gb_1 = gb * n;
+        double gb_2 = gb * ((n + block_size - 1) / block_size);
+        std::cout
+            << "c " << c
+            << " n " << n
+            << " kernel " << t_1 << "s " << gb_1 << "GB"
+            << " tiled " << t_2 << "s " << gb_2 << "GB"
+            << " (" << block_size << " items per pass)"
+            << " speedup " << t_1 / t_2
+            << std::endl;
+    }
+
+    return 0;
+}
+
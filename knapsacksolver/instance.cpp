@@ -295,6 +295,51 @@ std::vector<Weight> Instance::min_weights() const
     return min_weight;
 }
 
+bool Instance::is_subsetsum() const
+{
+    for (ItemPos j = 0; j < item_number(); ++j)
+        if (item(j).p != item(j).w)
+            return false;
+    return true;
+}
+
+Weight Instance::gcd_weights() const
+{
+    Weight g = 0;
+    for (ItemPos j = 0; j < item_number() && g != 1; ++j)
+        for (Weight w = item(j).w; w != 0; ) {
+            Weight r = g % w;
+            g = w;
+            w = r;
+        }
+    return g;
+}
+
+Profit Instance::gcd_profits() const
+{
+    Profit g = 0;
+    for (ItemPos j = 0; j < item_number() && g != 1; ++j)
+        for (Profit p = item(j).p; p != 0; ) {
+            Profit r = g % p;
+            g = p;
+            p = r;
+        }
+    return g;
+}
+
+int Instance::state_offset_size() const
+{
+    Weight w = 0;
+    Profit p = 0;
+    for (ItemPos j = 0; j < item_number(); ++j) {
+        w += item(j).w;
+        p += item(j).p;
+        if (w > INT32_MAX || p > INT32_MAX)
+            return 8;
+    }
+    return 4;
+}
+
 std::vector<Item> Instance::get_isum() const
 {
     assert(sort_type() == 2);
@@ -1176,6 +1221,21 @@ void Instance::fix(Info& info, const std::vector<int> vec)
 
 /******************************************************************************/
 
+void Instance::divide_weights_floor(Weight divisor)
+{
+    for (ItemPos j = 0; j < item_number(); ++j)
+        items_[j].w /= divisor;
+    c_orig_ /= divisor;
+}
+
+void Instance::divide_profits_floor(Profit divisor)
+{
+    for (ItemPos j = 0; j < item_number(); ++j)
+        items_[j].p /= divisor;
+}
+
+/******************************************************************************/
+
 void Instance::surrogate(Info& info, Weight multiplier, ItemIdx bound)
 {
     surrogate(info, multiplier, bound, first_item());
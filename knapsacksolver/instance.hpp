@@ -23,10 +23,10 @@ typedef int64_t Counter;
 typedef double Effciency;
 
 class Solution;
-typedef int64_t PartSol1;
-typedef int64_t PartSol2;
-class PartSolFactory1;
-class PartSolFactory2;
+typedef uint64_t PartSol1;
+typedef uint64_t PartSol2;
+template <typename PartSol = PartSol1> class PartSolFactory1;
+template <typename PartSol = PartSol2> class PartSolFactory2;
 
 struct Item
 {
@@ -107,6 +107,18 @@ public:
      * so that item b and b + 1 can be added.  */
     ItemPos beta2(Info& info) const;
     std::vector<Weight> min_weights() const;
+    /** Return true iff the profit of each item is equal to its weight.  */
+    bool is_subsetsum() const;
+    /** Greatest common divisor of the weights of the items.  */
+    Weight gcd_weights() const;
+    /** Greatest common divisor of the profits of the items.  */
+    Profit gcd_profits() const;
+    /**
+     * Size in bytes (4 or 8) of the smallest signed integer type which can
+     * store the difference between the weights (resp. the profits) of any
+     * two sets of items.
+     */
+    int state_offset_size() const;
 
     /** Sort items according to non-increasing profit-to-weight ratio.  */
     void sort(Info& info);
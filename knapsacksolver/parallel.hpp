@@ -0,0 +1,221 @@
+#pragma once
+
+#include "knapsacksolver/instance.hpp"
+
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <thread>
+#include <deque>
+#include <vector>
+
+namespace knapsacksolver
+{
+
+/**
+ * Reusable thread barrier.
+ *
+ * The last thread arriving at the barrier calls "completion" before the
+ * threads are released, like std::barrier from C++20.
+ */
+class Barrier
+{
+
+public:
+
+    Barrier(Counter thread_number, std::function<void()> completion = [](){ }):
+        thread_number_(thread_number), completion_(completion) { }
+
+    void arrive_and_wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        Counter generation = generation_;
+        arrived_++;
+        if (arrived_ == thread_number_) {
+            completion_();
+            arrived_ = 0;
+            generation_++;
+            cv_.notify_all();
+        } else {
+            cv_.wait(lock, [this, generation] { return generation != generation_; });
+        }
+    }
+
+private:
+
+    Counter thread_number_;
+    std::function<void()> completion_;
+    Counter arrived_ = 0;
+    Counter generation_ = 0;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+
+};
+
+/**
+ * Number of threads which can still be started by a fork-join algorithm.
+ *
+ * Threads are given back as soon as their task terminates, so that they can
+ * be reused by the other branches of the recursion.
+ */
+class ThreadBudget
+{
+
+public:
+
+    ThreadBudget(Counter thread_number): available_(thread_number - 1) { }
+
+    bool acquire()
+    {
+        Counter available = available_.load();
+        while (available > 0)
+            if (available_.compare_exchange_weak(available, available - 1))
+                return true;
+        return false;
+    }
+
+    void release() { available_++; }
+
+private:
+
+    std::atomic<Counter> available_;
+
+};
+
+/**
+ * Pool of thread_number - 1 threads running tasks pushed while the algorithm
+ * runs, for tree searches whose subtrees don't need to be joined by their
+ * parent.
+ *
+ * A task is only pushed if a thread is waiting for it, so that the queue
+ * stays short and the other sub-problems are solved by the thread which
+ * created them.
+ */
+class ThreadPool
+{
+
+public:
+
+    ThreadPool(Counter thread_number)
+    {
+        for (Counter i = 0; i < thread_number - 1; ++i)
+            threads_.push_back(std::thread([this]() { run(); }));
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (std::thread& thread: threads_)
+            thread.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Return true if a thread is waiting for a task. Since it is not
+     * synchronized, the result may already be outdated.
+     */
+    bool idle() const { return idle_.load(std::memory_order_relaxed) > 0; }
+
+    /**
+     * Push task if a thread is waiting for it. Return false otherwise.
+     */
+    bool try_push(const std::function<void()>& task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (idle_ == 0)
+                return false;
+            idle_--;
+            tasks_.push_back(task);
+        }
+        cv_.notify_all();
+        return true;
+    }
+
+    /**
+     * Run the tasks of the queue on the calling thread too, until all the
+     * tasks are done.
+     */
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            idle_++;
+            cv_.wait(lock, [this]() { return !tasks_.empty() || running_ == 0; });
+            if (tasks_.empty()) {
+                idle_--;
+                return;
+            }
+            run_task(lock);
+        }
+    }
+
+private:
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            idle_++;
+            cv_.wait(lock, [this]() { return !tasks_.empty() || stop_; });
+            if (tasks_.empty()) {
+                idle_--;
+                return;
+            }
+            run_task(lock);
+        }
+    }
+
+    /** Run the first task of the queue, the lock is held before and after.  */
+    void run_task(std::unique_lock<std::mutex>& lock)
+    {
+        // idle_ has already been decremented when the task was pushed.
+        std::function<void()> task = std::move(tasks_.front());
+        tasks_.pop_front();
+        running_++;
+        lock.unlock();
+        task();
+        lock.lock();
+        running_--;
+        if (running_ == 0 && tasks_.empty())
+            cv_.notify_all();
+    }
+
+    std::vector<std::thread> threads_;
+    std::deque<std::function<void()>> tasks_;
+    /** Number of threads waiting for a task, minus the tasks of the queue.  */
+    std::atomic<Counter> idle_ {0};
+    /** Number of tasks being run.  */
+    Counter running_ = 0;
+    bool stop_ = false;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+
+};
+
+/**
+ * Run f1 and f2, on a new thread for f2 if budget is not NULL and a thread
+ * is available, sequentially otherwise.
+ */
+inline void fork_join(ThreadBudget* budget,
+        const std::function<void()>& f1, const std::function<void()>& f2)
+{
+    if (budget != NULL && budget->acquire()) {
+        std::thread thread([budget, &f2]() { f2(); budget->release(); });
+        f1();
+        thread.join();
+    } else {
+        f1();
+        f2();
+    }
+}
+
+}
+
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "knapsacksolver/instance.hpp"
+
+#include <bitset>
+
+#if defined(__SIZEOF_INT128__)
+#define KNAPSACKSOLVER_PARTSOL_INT128
+#endif
+
+namespace knapsacksolver
+{
+
+/**
+ * Maximum size of a partial solution.
+ */
+const ItemPos PARTSOL_SIZE_MAX = 512;
+
+/**
+ * Bit operations on the words used to store partial solutions: unsigned
+ * integers (uint64_t, unsigned __int128) and std::bitset.
+ */
+template <typename PartSol>
+struct PartSolWord
+{
+    static const ItemPos size = 8 * sizeof(PartSol);
+    static PartSol bit(ItemPos j) { return (PartSol)1 << j; }
+    static int test(const PartSol& s, ItemPos j) { return (s >> j) & 1; }
+};
+
+template <std::size_t N>
+struct PartSolWord<std::bitset<N>>
+{
+    static const ItemPos size = N;
+    static std::bitset<N> bit(ItemPos j) { return std::bitset<N>().set(j); }
+    static int test(const std::bitset<N>& s, ItemPos j) { return s.test(j); }
+};
+
+/**
+ * Return the number of bits (64, 128, 256 or 512) of the smallest word which
+ * can store a partial solution of the given size:
+ * - 64: uint64_t
+ * - 128: unsigned __int128, if supported by the compiler
+ * - 256: std::bitset<256>
+ * - 512: std::bitset<512>
+ */
+inline ItemPos partsol_word_size(ItemPos size)
+{
+    if (size <= 64)
+        return 64;
+#if defined(KNAPSACKSOLVER_PARTSOL_INT128)
+    if (size <= 128)
+        return 128;
+#endif
+    if (size <= 256)
+        return 256;
+    return 512;
+}
+
+}
+
@@ -1,10 +1,16 @@
 #pragma once
 
 #include "knapsacksolver/solution.hpp"
+#include "knapsacksolver/part_solution.hpp"
 
 namespace knapsacksolver
 {
 
+/**
+ * Partial solutions on the size items around the break item, stored in a
+ * word of type PartSol (see PartSolWord).
+ */
+template <typename PartSol>
 class PartSolFactory1
 {
 
@@ -13,6 +19,7 @@ public:
     PartSolFactory1(const Instance& ins, ItemPos size, ItemPos b, ItemPos f, ItemPos l):
         instance_(ins), size_(size), b_(b), f_(f), l_(l)
     {
+        assert(size <= PartSolWord<PartSol>::size);
         if (l-f+1 < size) {
             x1_ = f;
             x2_ = l;
@@ -32,44 +39,44 @@ public:
     ItemPos x2() const { return x2_; }
     ItemPos size() const { return x2_ - x1_ + 1; }
 
-    PartSol1 bsol_break() const
+    PartSol bsol_break() const
     {
-        PartSol1 bsolbreak = 0UL;
+        PartSol bsolbreak = PartSol();
         for (ItemPos j = x1_; j < b_; ++j)
             add(bsolbreak, j);
         return bsolbreak;
     }
 
-    int contains(PartSol1 s, ItemPos j) const
+    int contains(PartSol s, ItemPos j) const
     {
         assert(x1_ <= j && j <= x2_);
-        return ((s >> (j-x1_)) & 1UL);
+        return PartSolWord<PartSol>::test(s, j-x1_);
     }
 
-    PartSol1 add(const PartSol1& s, ItemPos j) const
+    PartSol add(const PartSol& s, ItemPos j) const
     {
         if (j < x1_ || x2_ < j)
             return s;
         assert(!contains(s,j));
-        return (s | (1UL << (j-x1_)));
+        return (s | PartSolWord<PartSol>::bit(j-x1_));
     }
 
-    PartSol1 remove(const PartSol1& s, ItemPos j) const
+    PartSol remove(const PartSol& s, ItemPos j) const
     {
         if (j < x1_ || x2_ < j)
             return s;
         assert(contains(s,j));
-        return (s & (~(1UL << (j-x1_))));
+        return (s & ~PartSolWord<PartSol>::bit(j-x1_));
     }
 
-    PartSol1 toggle(PartSol1& s, ItemPos j) const
+    PartSol toggle(PartSol& s, ItemPos j) const
     {
         if (j < x1_ || x2_ < j)
             return s;
-        return (s ^ (1UL << (j-x1_)));
+        return (s ^ PartSolWord<PartSol>::bit(j-x1_));
     }
 
-    std::string print(PartSol1& s) const
+    std::string print(PartSol& s) const
     {
         std::string str = "";
         for (ItemPos j = x1_; j <= x2_; ++j)
@@ -77,7 +84,7 @@ public:
         return str;
     }
 
-    std::vector<int> vector(PartSol1& s) const
+    std::vector<int> vector(PartSol& s) const
     {
         ItemPos f = std::max(instance_.first_item(), x1());
         ItemPos l = std::min(instance_.last_item(), x2());
@@ -87,7 +94,7 @@ public:
         return vec;
     }
 
-    void update_solution(PartSol1 psol, Solution& sol)
+    void update_solution(PartSol psol, Solution& sol)
     {
         for (ItemPos j = x1(); j <= x2(); ++j)
             sol.set(j, contains(psol, j));
@@ -1,10 +1,16 @@
 #pragma once
 
 #include "knapsacksolver/solution.hpp"
+#include "knapsacksolver/part_solution.hpp"
 
 namespace knapsacksolver
 {
 
+/**
+ * Partial solutions on the last size items added, stored in a word of type
+ * PartSol (see PartSolWord).
+ */
+template <typename PartSol>
 class PartSolFactory2
 {
 
@@ -12,6 +18,7 @@ public:
 
     PartSolFactory2(const Instance& ins, ItemPos size): instance_(ins), size_(size)
     {
+        assert(size <= PartSolWord<PartSol>::size);
         idx_ = std::vector<ItemPos>(size, -1);
     }
 
@@ -20,34 +27,34 @@ public:
         std::fill(idx_.begin(), idx_.end(), -1);
     }
 
-    PartSolFactory2(Instance& ins): PartSolFactory2(ins, 64) {  }
+    PartSolFactory2(Instance& ins): PartSolFactory2(ins, PartSolWord<PartSol>::size) {  }
 
     ItemPos size() const { return size_; }
 
     const std::vector<ItemPos>& indices() const { return idx_; }
 
-    int contains(PartSol2 s, ItemPos j) const
+    int contains(PartSol s, ItemPos j) const
     {
-        return ((s >> j) & 1UL);
+        return PartSolWord<PartSol>::test(s, j);
     }
 
-    PartSol2 add(const PartSol2& s) const
+    PartSol add(const PartSol& s) const
     {
-        return (s | (1UL << cur_));
+        return (s | cur_bit_);
     }
 
-    PartSol2 remove(const PartSol2& s) const
+    PartSol remove(const PartSol& s) const
     {
-        return (s & (~(1UL << cur_)));
+        return (s & ~cur_bit_);
     }
 
-    PartSol2 toggle(PartSol2& s, ItemPos j) const
+    PartSol toggle(PartSol& s, ItemPos j) const
     {
         assert(0 <= j && j < size_);
-        return (s ^ (1UL << j));
+        return (s ^ PartSolWord<PartSol>::bit(j));
     }
 
-    std::string print(PartSol2& s) const
+    std::string print(PartSol& s) const
     {
         std::string str = "";
         for (ItemPos j = 0; j < size_; ++j) {
@@ -70,15 +77,22 @@ public:
         return str;
     }
 
+    /**
+     * Return true iff the next item added will replace the oldest one, that
+     * is, after each size items added.
+     */
+    bool cycle_end() const { return cur_ == size_ - 1; }
+
     void add_item(ItemPos j)
     {
         cur_++;
         if (cur_ == size_)
             cur_ = 0;
         idx_[cur_] = j;
+        cur_bit_ = PartSolWord<PartSol>::bit(cur_);
     }
 
-    std::vector<int> vector(PartSol2& s) const
+    std::vector<int> vector(PartSol& s) const
     {
         std::vector<int> vec(instance_.item_number(), 0);
         for (ItemPos j = 0; j < size(); ++j) {
@@ -90,10 +104,11 @@ public:
         return vec;
     }
 
-    void update_solution(PartSol2 psol, Solution& sol)
+    void update_solution(PartSol psol, Solution& sol) const
     {
         for (ItemPos j = 0; j < size(); ++j)
-            sol.set(indices()[j], contains(psol, j));
+            if (indices()[j] != -1)
+                sol.set(indices()[j], contains(psol, j));
     }
 
 private:
@@ -102,6 +117,7 @@ private:
     ItemPos size_;
     std::vector<ItemPos> idx_;
     ItemPos cur_ = -1;
+    PartSol cur_bit_ = PartSol();
 
 };
 
@@ -37,8 +37,8 @@ public:
     void clear();
     void resize(ItemIdx n) { x_.resize(n, 0); }
 
-    void update_from_partsol(const PartSolFactory1& psolf, PartSol1 psol);
-    void update_from_partsol(const PartSolFactory2& psolf, PartSol2 psol);
+    void update_from_partsol(const PartSolFactory1<>& psolf, PartSol1 psol);
+    void update_from_partsol(const PartSolFactory2<>& psolf, PartSol2 psol);
 
     /**
      * Write the solution in the input file.
@@ -30,6 +30,37 @@ TEST(Instance, Sort)
     EXPECT_EQ(instancetance.item(0).j, 4);
 }
 
+TEST(Instance, Gcd)
+{
+    Instance instance(20, {
+            {6, 4},
+            {9, 8},
+            {15, 12}});
+    EXPECT_EQ(instance.gcd_weights(), 3);
+    EXPECT_EQ(instance.gcd_profits(), 4);
+
+    instance.divide_weights_floor(3);
+    EXPECT_EQ(instance.capacity(), 6);
+    EXPECT_EQ(instance.item(0).w, 2);
+    EXPECT_EQ(instance.item(1).w, 3);
+    EXPECT_EQ(instance.item(2).w, 5);
+}
+
+TEST(Instance, StateOffsetSize)
+{
+    Instance instance(20, {
+            {6, 4},
+            {9, 8},
+            {15, 12}});
+    EXPECT_EQ(instance.state_offset_size(), 4);
+
+    Instance instance_large(1 << 30, {
+            {1 << 30, 4},
+            {1 << 30, 8},
+            {15, 12}});
+    EXPECT_EQ(instance_large.state_offset_size(), 8);
+}
+
 TEST(Instance, SortPartially)
 {
     Instance instancetance(4, {
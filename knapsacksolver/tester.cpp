@@ -246,6 +246,10 @@ void knapsacksolver::test(
         PisingerInstances instances({2, 5, 10, 20, 50, 100, 200, 500}, {10, 100, 1000}, {"sc"}, 3);
         test(instances, algorithms, test_type);
         break;
+    } case SUBSETSUM: {
+        PisingerInstances instances({1, 10, 50, 100}, {100, 1000}, {"ss"}, 2);
+        test(instances, algorithms, test_type);
+        break;
     } default: {
     }
     }
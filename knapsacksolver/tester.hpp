@@ -8,7 +8,7 @@ namespace knapsacksolver
 {
 
 enum TestType { SOPT, OPT, LB, UB };
-enum InstacesType { TEST, SMALL, MEDIUM, SC };
+enum InstacesType { TEST, SMALL, MEDIUM, SC, SUBSETSUM };
 
 void test(InstacesType instances_type, std::vector<Output (*)(Instance&)> algorithms, TestType test_type = SOPT);
 